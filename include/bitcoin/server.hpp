@@ -31,9 +31,23 @@
 #include <bitcoin/server/services/block_service.hpp>
 #include <bitcoin/server/services/heartbeat_service.hpp>
 #include <bitcoin/server/services/query_service.hpp>
+#include <bitcoin/server/services/statistics_service.hpp>
 #include <bitcoin/server/services/transaction_service.hpp>
-#include <bitcoin/server/utility/address_key.hpp>
 #include <bitcoin/server/utility/authenticator.hpp>
+#include <bitcoin/server/utility/block_event.hpp>
+#include <bitcoin/server/utility/chain_tip.hpp>
+#include <bitcoin/server/utility/history_page.hpp>
+#include <bitcoin/server/utility/latency_histogram.hpp>
+#include <bitcoin/server/utility/mpsc_queue.hpp>
+#include <bitcoin/server/utility/prefix_trie.hpp>
+#include <bitcoin/server/utility/publish_queue.hpp>
+#include <bitcoin/server/utility/query_coalescer.hpp>
+#include <bitcoin/server/utility/query_statistics.hpp>
+#include <bitcoin/server/utility/rate_limiter.hpp>
+#include <bitcoin/server/utility/response_cache.hpp>
+#include <bitcoin/server/utility/timer_wheel.hpp>
+#include <bitcoin/server/utility/transaction_event.hpp>
+#include <bitcoin/server/utility/wakeup.hpp>
 #include <bitcoin/server/workers/notification_worker.hpp>
 #include <bitcoin/server/workers/query_worker.hpp>
 
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_MPSC_QUEUE_IPP
+#define LIBBITCOIN_SERVER_MPSC_QUEUE_IPP
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace libbitcoin {
+namespace server {
+
+// The queue always holds one sentinel node, whose item storage is empty.
+template <typename Item>
+mpsc_queue<Item>::mpsc_queue()
+  : head_(new node), tail_(head_.load()), size_(0)
+{
+    tail_->next.store(nullptr, std::memory_order_relaxed);
+}
+
+template <typename Item>
+mpsc_queue<Item>::~mpsc_queue()
+{
+    // Destroy any remaining items, there are no producers at this point.
+    for (auto next = tail_->next.load(); next != nullptr;)
+    {
+        item(next).~Item();
+        delete tail_;
+        tail_ = next;
+        next = tail_->next.load();
+    }
+
+    delete tail_;
+}
+
+template <typename Item>
+Item& mpsc_queue<Item>::item(node* value)
+{
+    return *reinterpret_cast<Item*>(&value->item);
+}
+
+template <typename Item>
+void mpsc_queue<Item>::push(Item&& value)
+{
+    const auto added = new node;
+    new (&added->item) Item(std::move(value));
+    added->next.store(nullptr, std::memory_order_relaxed);
+
+    // Count before linking so that the consumer never observes a negative.
+    ++size_;
+
+    // Serialize producers on the head, then publish to the consumer.
+    const auto prior = head_.exchange(added, std::memory_order_acq_rel);
+    prior->next.store(added, std::memory_order_release);
+}
+
+template <typename Item>
+bool mpsc_queue<Item>::pop(Item& out)
+{
+    const auto next = tail_->next.load(std::memory_order_acquire);
+
+    // Empty, or a producer has exchanged the head but not yet linked it.
+    if (next == nullptr)
+        return false;
+
+    // The next node becomes the sentinel once its item is moved out.
+    out = std::move(item(next));
+    item(next).~Item();
+    delete tail_;
+    tail_ = next;
+    --size_;
+    return true;
+}
+
+template <typename Item>
+size_t mpsc_queue<Item>::size() const
+{
+    return size_.load();
+}
+
+template <typename Item>
+bool mpsc_queue<Item>::empty() const
+{
+    return size() == 0;
+}
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
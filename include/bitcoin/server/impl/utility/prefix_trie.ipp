@@ -0,0 +1,201 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_PREFIX_TRIE_IPP
+#define LIBBITCOIN_SERVER_PREFIX_TRIE_IPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+template <typename Value>
+prefix_trie<Value>::prefix_trie()
+  : size_(0)
+{
+}
+
+template <typename Value>
+size_t prefix_trie<Value>::size() const
+{
+    return size_;
+}
+
+template <typename Value>
+bool prefix_trie<Value>::empty() const
+{
+    return size_ == 0;
+}
+
+template <typename Value>
+void prefix_trie<Value>::insert(const binary& prefix, const Value& value)
+{
+    auto current = &root_;
+
+    for (size_t bit = 0; bit < prefix.size(); ++bit)
+    {
+        auto& child = current->children[prefix[bit] ? 1 : 0];
+
+        if (!child)
+            child.reset(new node);
+
+        current = child.get();
+    }
+
+    current->values.push_back(value);
+    ++size_;
+}
+
+template <typename Value>
+template <typename Predicate>
+Value prefix_trie<Value>::find(const binary& prefix,
+    Predicate predicate) const
+{
+    const auto current = locate(prefix);
+
+    if (current == nullptr)
+        return{};
+
+    const auto& values = current->values;
+    const auto it = std::find_if(values.begin(), values.end(), predicate);
+    return it == values.end() ? Value{} : *it;
+}
+
+template <typename Value>
+template <typename Predicate>
+size_t prefix_trie<Value>::remove(const binary& prefix, Predicate predicate)
+{
+    // The path retains each node of the prefix so that empty nodes are pruned.
+    std::vector<node*> path{ &root_ };
+
+    for (size_t bit = 0; bit < prefix.size(); ++bit)
+    {
+        const auto& child = path.back()->children[prefix[bit] ? 1 : 0];
+
+        if (!child)
+            return 0;
+
+        path.push_back(child.get());
+    }
+
+    const auto removed = erase(path.back()->values, predicate);
+
+    for (auto bit = prefix.size(); bit > 0 && barren(*path[bit]); --bit)
+        path[bit - 1]->children[prefix[bit - 1] ? 1 : 0].reset();
+
+    size_ -= removed;
+    return removed;
+}
+
+template <typename Value>
+template <typename Predicate>
+size_t prefix_trie<Value>::remove_if(Predicate predicate)
+{
+    const auto removed = remove_if(root_, predicate);
+    size_ -= removed;
+    return removed;
+}
+
+template <typename Value>
+template <typename Visitor>
+void prefix_trie<Value>::match(const data_slice& field,
+    Visitor visitor) const
+{
+    static constexpr size_t last_bit = byte_bits - 1;
+    const auto bits = field.size() * byte_bits;
+    const auto bytes = field.data();
+    auto current = &root_;
+
+    for (size_t bit = 0; ; ++bit)
+    {
+        for (const auto& value: current->values)
+            visitor(value);
+
+        if (bit == bits)
+            return;
+
+        // The most significant bit of each byte is first, as in binary.
+        const auto shift = last_bit - (bit % byte_bits);
+        const auto child = (bytes[bit / byte_bits] >> shift) & 1;
+        current = current->children[child].get();
+
+        if (current == nullptr)
+            return;
+    }
+}
+
+// private
+//-----------------------------------------------------------------------------
+
+template <typename Value>
+template <typename Predicate>
+size_t prefix_trie<Value>::erase(std::vector<Value>& values,
+    Predicate predicate)
+{
+    const auto end = std::remove_if(values.begin(), values.end(), predicate);
+    const auto removed = static_cast<size_t>(std::distance(end, values.end()));
+    values.erase(end, values.end());
+    return removed;
+}
+
+template <typename Value>
+template <typename Predicate>
+size_t prefix_trie<Value>::remove_if(node& parent, Predicate predicate)
+{
+    auto removed = erase(parent.values, predicate);
+
+    for (auto& child: parent.children)
+    {
+        if (!child)
+            continue;
+
+        removed += remove_if(*child, predicate);
+
+        if (barren(*child))
+            child.reset();
+    }
+
+    return removed;
+}
+
+template <typename Value>
+bool prefix_trie<Value>::barren(const node& value)
+{
+    return value.values.empty() && !value.children[0] && !value.children[1];
+}
+
+template <typename Value>
+const typename prefix_trie<Value>::node* prefix_trie<Value>::locate(
+    const binary& prefix) const
+{
+    auto current = &root_;
+
+    for (size_t bit = 0; current != nullptr && bit < prefix.size(); ++bit)
+        current = current->children[prefix[bit] ? 1 : 0].get();
+
+    return current;
+}
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
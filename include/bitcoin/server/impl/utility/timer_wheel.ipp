@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_TIMER_WHEEL_IPP
+#define LIBBITCOIN_SERVER_TIMER_WHEEL_IPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+template <typename Value>
+timer_wheel<Value>::timer_wheel(const asio::duration& tick)
+  : tick_(tick), start_(asio::steady_clock::now()), current_(0), size_(0)
+{
+}
+
+template <typename Value>
+size_t timer_wheel<Value>::size() const
+{
+    return size_;
+}
+
+template <typename Value>
+void timer_wheel<Value>::schedule(const time_point& due, const Value& value)
+{
+    // A value is never due on the current tick, which has been processed.
+    const auto tick = std::max(to_tick(due, true), current_ + 1);
+    insert({ std::min(tick, current_ + horizon - 1), value });
+    ++size_;
+}
+
+template <typename Value>
+template <typename Handler>
+void timer_wheel<Value>::advance(const time_point& now, Handler handler)
+{
+    const auto target = to_tick(now, false);
+
+    while (current_ < target)
+    {
+        ++current_;
+
+        // Cascade each higher level slot that begins on this tick, highest
+        // first, so that its values settle into the lower levels.
+        for (auto index = level_count - 1; index > 0; --index)
+        {
+            const auto shift = level_bits * index;
+
+            if ((current_ & ((uint64_t(1) << shift) - 1)) != 0)
+                continue;
+
+            slot cascade;
+            cascade.swap(levels_[index][(current_ >> shift) & slot_mask]);
+
+            for (auto& value: cascade)
+                insert(std::move(value));
+        }
+
+        // The handler may schedule, so the due slot is emptied first.
+        slot due;
+        due.swap(levels_[0][current_ & slot_mask]);
+        size_ -= due.size();
+
+        for (const auto& value: due)
+            handler(value.value);
+    }
+}
+
+// private
+//-----------------------------------------------------------------------------
+
+// Due times are rounded up and the current time down, so that a value is
+// never due before its time.
+template <typename Value>
+uint64_t timer_wheel<Value>::to_tick(const time_point& time,
+    bool round_up) const
+{
+    if (time <= start_)
+        return 0;
+
+    const auto elapsed = time - start_;
+    const auto rounding = round_up ? tick_ - asio::duration(1) :
+        asio::duration(0);
+
+    return static_cast<uint64_t>((elapsed + rounding) / tick_);
+}
+
+// The value is placed at the lowest level that spans its remaining ticks.
+template <typename Value>
+void timer_wheel<Value>::insert(entry&& value)
+{
+    const auto remaining = value.tick - current_;
+    size_t index = 0;
+
+    while (index < level_count - 1 &&
+        remaining >= (uint64_t(1) << (level_bits * (index + 1))))
+        ++index;
+
+    const auto position = (value.tick >> (level_bits * index)) & slot_mask;
+    levels_[index][position].push_back(std::move(value));
+}
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
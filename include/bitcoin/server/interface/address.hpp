@@ -41,6 +41,7 @@ public:
 
 private:
     static bool unwrap_subscribe2_args(binary& prefix_filter,
+        uint32_t& ttl_seconds, notification_worker::mode& delivery,
         const message& request);
 };
 
@@ -21,10 +21,16 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
 #include <bitcoin/blockchain.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/utility/chain_tip.hpp>
+#include <bitcoin/server/utility/history_page.hpp>
+#include <bitcoin/server/utility/response_cache.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -39,6 +45,15 @@ public:
     static void fetch_history2(server_node& node,
         const message& request, send_handler handler);
 
+    /// Fetch a page of the blockchain history of a payment address, following
+    /// the row identified by the cursor of the previous page.
+    static void fetch_history4(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch the blockchain history of each of a batch of payment addresses.
+    static void fetch_history3(server_node& node,
+        const message& request, send_handler handler);
+
     /// Fetch a transaction from the blockchain by its hash.
     static void fetch_transaction(server_node& node,
         const message& request, send_handler handler);
@@ -84,10 +99,40 @@ public:
         send_handler handler);
 
 private:
+    typedef std::pair<code, chain::history_compact::list> history_result;
+    typedef std::shared_ptr<std::vector<history_result>> history_results;
+
+    static bool cached(server_node& node, response_cache::kind type,
+        const hash_digest& hash, const message& request,
+        send_handler handler);
+
+    static send_handler cache_handler(server_node& node,
+        response_cache::kind type, const hash_digest& hash,
+        send_handler handler);
+
     static void history_fetched(const code& ec,
         const chain::history_compact::list& history, const message& request,
         send_handler handler);
 
+    static void fetch_history_page(server_node& node,
+        const wallet::payment_address& address, size_t from_height,
+        const history_page& page, size_t limit, const message& request,
+        send_handler handler);
+
+    static void history_page_fetched(const code& ec,
+        const chain::history_compact::list& history, server_node& node,
+        const wallet::payment_address& address, size_t from_height,
+        history_page page, size_t limit, const message& request,
+        send_handler handler);
+
+    static void history_batch_fetched(const code& ec,
+        const chain::history_compact::list& history, size_t index,
+        history_results results, result_handler complete);
+
+    static void history_batch_completed(const code& ec,
+        history_results results, const message& request,
+        send_handler handler);
+
     static void transaction_fetched(const code& ec, transaction_ptr tx, size_t,
         size_t, const message& request, send_handler handler);
 
@@ -104,6 +149,9 @@ private:
         header_const_ptr header, const message& request,
         send_handler handler);
 
+    static void tip_header_fetched(const chain_tip::state& tip,
+        const message& request, send_handler handler);
+
     static void fetch_block_transaction_hashes_by_hash(server_node& node,
         const message& request, send_handler handler);
 
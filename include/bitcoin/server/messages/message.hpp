@@ -42,6 +42,9 @@ public:
     //// Construct a response for the request (data with code).
     message(const message& request, const data_chunk& data);
 
+    //// Construct a response for the request (data with code, moved).
+    message(const message& request, data_chunk&& data);
+
     //// Construct a response for the route (subscription code only).
     message(const server::route& route, const std::string& command,
         uint32_t id, const code& ec);
@@ -50,6 +53,10 @@ public:
     message(const server::route& route, const std::string& command,
         uint32_t id, const data_chunk& data);
 
+    //// Construct a response for the route (subscription data, moved).
+    message(const server::route& route, const std::string& command,
+        uint32_t id, data_chunk&& data);
+
     /// Arbitrary caller data (returned to caller for correlation).
     uint32_t id() const;
 
@@ -65,7 +72,7 @@ public:
     /// Receive a message via the socket.
     code receive(bc::protocol::zmq::socket& socket);
 
-    /// Send the message via the socket.
+    /// Send the message via the socket, the data is moved to the frame.
     code send(bc::protocol::zmq::socket& socket);
 
 private:
@@ -21,6 +21,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <ostream>
 #include <bitcoin/node.hpp>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/configuration.hpp>
@@ -30,8 +31,13 @@
 #include <bitcoin/server/services/block_service.hpp>
 #include <bitcoin/server/services/heartbeat_service.hpp>
 #include <bitcoin/server/services/query_service.hpp>
+#include <bitcoin/server/services/statistics_service.hpp>
 #include <bitcoin/server/services/transaction_service.hpp>
 #include <bitcoin/server/utility/authenticator.hpp>
+#include <bitcoin/server/utility/chain_tip.hpp>
+#include <bitcoin/server/utility/query_coalescer.hpp>
+#include <bitcoin/server/utility/query_statistics.hpp>
+#include <bitcoin/server/utility/response_cache.hpp>
 #include <bitcoin/server/workers/notification_worker.hpp>
 
 namespace libbitcoin {
@@ -57,6 +63,21 @@ public:
     /// Server configuration settings.
     virtual const settings& server_settings() const;
 
+    /// The top block of the chain, updated on reorganization.
+    virtual const chain_tip& tip() const;
+
+    /// Cache of immutable query responses, invalidated on reorganization.
+    virtual response_cache& cache();
+
+    /// Query statistics of the secure or public query service.
+    virtual query_statistics& statistics(bool secure);
+
+    /// Coalescer of identical in-flight queries, shared by all workers.
+    virtual query_coalescer& coalescer();
+
+    /// Write query and publisher statistics in text exposition format.
+    virtual void report(std::ostream& output);
+
     // Run sequence.
     // ------------------------------------------------------------------------
 
@@ -81,8 +102,10 @@ public:
 
     /// Subscribe to address (including stealth) prefix notifications.
     /// Stealth prefix is limited to 32 bits, address prefix to 256 bits.
+    /// A nonzero time to live shortens the configured expiration.
     virtual code subscribe_address(const route& reply_to, uint32_t id,
-        const binary& prefix_filter, bool unsubscribe);
+        const binary& prefix_filter, uint32_t ttl_seconds,
+        notification_worker::mode delivery, bool unsubscribe);
 
     /////// Subscribe to transaction penetration notifications.
     ////virtual void subscribe_penetration(const route& reply_to, uint32_t id,
@@ -90,13 +113,22 @@ public:
 
 private:
     void handle_running(const code& ec, result_handler handler);
+    bool handle_reorganization(const code& ec, size_t fork_height,
+        block_const_ptr_list_const_ptr new_blocks,
+        block_const_ptr_list_const_ptr old_blocks);
+    void handle_last_height(const code& ec, size_t height);
+    void handle_tip_header(const code& ec, header_const_ptr header,
+        size_t height);
+    bool handle_transaction_pool(const code& ec, transaction_const_ptr tx);
 
     bool start_services();
     bool start_authenticator();
+    void start_chain_tip();
     bool start_query_services();
     bool start_heartbeat_services();
     bool start_block_services();
     bool start_transaction_services();
+    bool start_statistics_service();
     bool start_query_workers(bool secure);
     bool start_notification_workers(bool secure);
 
@@ -104,6 +136,11 @@ private:
 
     // These are thread safe.
     authenticator authenticator_;
+    chain_tip tip_;
+    response_cache cache_;
+    query_coalescer coalescer_;
+    query_statistics secure_statistics_;
+    query_statistics public_statistics_;
     query_service secure_query_service_;
     query_service public_query_service_;
     heartbeat_service secure_heartbeat_service_;
@@ -112,6 +149,7 @@ private:
     block_service public_block_service_;
     transaction_service secure_transaction_service_;
     transaction_service public_transaction_service_;
+    statistics_service statistics_service_;
     notification_worker secure_notification_worker_;
     notification_worker public_notification_worker_;
 };
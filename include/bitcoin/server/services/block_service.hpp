@@ -24,6 +24,9 @@
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/block_event.hpp>
+#include <bitcoin/server/utility/publish_queue.hpp>
+#include <bitcoin/server/utility/wakeup.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -38,46 +41,41 @@ class BCS_API block_service
 public:
     typedef std::shared_ptr<block_service> ptr;
 
-    /// The fixed inprocess worker endpoints.
-    static const config::endpoint public_worker;
-    static const config::endpoint secure_worker;
-
     /// Construct a block service.
     block_service(bc::protocol::zmq::authenticator& authenticator,
         server_node& node, bool secure);
 
-    /// Start the service.
-    bool start() override;
+    /// The queue of blocks awaiting publication.
+    const publish_queue& queue() const;
 
-    /// Stop the service.
-    bool stop() override;
+    /// Queue the blocks accepted into the long chain for publication.
+    virtual void publish(const block_event::list& events);
 
 protected:
     typedef bc::protocol::zmq::socket socket;
 
-    virtual bool bind(socket& xpub, socket& xsub);
-    virtual bool unbind(socket& xpub, socket& xsub);
+    virtual bool bind(socket& publisher);
+    virtual bool unbind(socket& publisher);
 
     // Implement the service.
     virtual void work() override;
 
-private:
-    bool handle_reorganization(const code& ec, size_t fork_height,
-        block_const_ptr_list_const_ptr new_blocks,
-        block_const_ptr_list_const_ptr old_blocks);
+    // Publish queued blocks (integrated worker).
+    void publish(socket& publisher);
 
-    void publish_blocks(uint32_t fork_height,
-        block_const_ptr_list_const_ptr blocks);
-    void publish_block(socket& publisher, uint32_t height,
-        block_const_ptr block);
+private:
+    void enqueue_block(const block_event& event);
+    bool enqueue(const block_event& event);
+    bool enqueue_topics(const block_event& event);
 
     const bool secure_;
     const bool verbose_;
     const server::settings& settings_;
 
     // These are thread safe.
+    publish_queue queue_;
     bc::protocol::zmq::authenticator& authenticator_;
-    server_node& node_;
+    wakeup wakeup_;
 };
 
 } // namespace server
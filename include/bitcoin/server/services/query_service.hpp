@@ -19,10 +19,13 @@
 #ifndef LIBBITCOIN_SERVER_QUERY_SERVICE_HPP
 #define LIBBITCOIN_SERVER_QUERY_SERVICE_HPP
 
+#include <cstddef>
 #include <memory>
+#include <string>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/rate_limiter.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -40,6 +43,8 @@ public:
     /// The fixed inprocess query and notify worker endpoints.
     static const config::endpoint public_query;
     static const config::endpoint secure_query;
+    static const config::endpoint public_heavy_query;
+    static const config::endpoint secure_heavy_query;
     static const config::endpoint public_notify;
     static const config::endpoint secure_notify;
 
@@ -51,17 +56,31 @@ protected:
     typedef bc::protocol::zmq::socket socket;
 
     virtual bool bind(socket& router, socket& query_dealer,
-        socket& notify_dealer);
+        socket& heavy_dealer, socket& notify_dealer);
     virtual bool unbind(socket& router, socket& query_dealer,
-        socket& notify_dealer);
+        socket& heavy_dealer, socket& notify_dealer);
+
+    // True if the command is of the heavy cost class.
+    virtual bool heavy(const std::string& command) const;
+
+    // Forward a query to the workers of its cost class, or reply busy if
+    // the client is over its limit.
+    virtual bool admit(socket& router, socket& query_dealer,
+        socket& heavy_dealer);
 
     // Implement the service.
     virtual void work();
 
 private:
     const bool secure_;
+    const bool lanes_;
+    const size_t heavy_limit_;
     const server::settings& settings_;
 
+    // These are used only on the service thread.
+    rate_limiter limiter_;
+    size_t heavy_pending_;
+
     // This is thread safe.
     bc::protocol::zmq::authenticator& authenticator_;
 };
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_STATISTICS_SERVICE_HPP
+#define LIBBITCOIN_SERVER_STATISTICS_SERVICE_HPP
+
+#include <memory>
+#include <string>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/settings.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// Reply to any request with a text report of server statistics.
+class BCS_API statistics_service
+  : public bc::protocol::zmq::worker
+{
+public:
+    typedef std::shared_ptr<statistics_service> ptr;
+
+    /// Construct a statistics endpoint.
+    statistics_service(bc::protocol::zmq::authenticator& authenticator,
+        server_node& node);
+
+protected:
+    typedef bc::protocol::zmq::socket socket;
+
+    virtual bool bind(socket& replier);
+    virtual bool unbind(socket& replier);
+
+    // Implement the service.
+    virtual void work();
+
+    // Reply to the request (integrated worker).
+    void reply(socket& replier);
+
+    // Format the report.
+    virtual std::string report();
+
+private:
+    const bool verbose_;
+    const server::settings& settings_;
+
+    // These are thread safe.
+    server_node& node_;
+    bc::protocol::zmq::authenticator& authenticator_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
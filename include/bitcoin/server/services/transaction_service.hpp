@@ -19,10 +19,16 @@
 #ifndef LIBBITCOIN_SERVER_TRANSACTION_SERVICE_HPP
 #define LIBBITCOIN_SERVER_TRANSACTION_SERVICE_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/publish_queue.hpp>
+#include <bitcoin/server/utility/transaction_event.hpp>
+#include <bitcoin/server/utility/wakeup.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -37,40 +43,63 @@ class BCS_API transaction_service
 public:
     typedef std::shared_ptr<transaction_service> ptr;
 
-    /// The fixed inprocess worker endpoints.
-    static const config::endpoint public_worker;
-    static const config::endpoint secure_worker;
-
     /// Construct a transaction service.
     transaction_service(bc::protocol::zmq::authenticator& authenticator,
         server_node& node, bool secure);
 
-    /// Start the service.
-    bool start() override;
+    /// The queue of transactions awaiting publication.
+    const publish_queue& queue() const;
+
+    /// The queue of transaction batches awaiting publication.
+    const publish_queue& batch_queue() const;
 
-    /// Stop the service.
-    bool stop() override;
+    /// Queue the transaction accepted into the pool for publication.
+    virtual void publish(const transaction_event& event);
 
 protected:
     typedef bc::protocol::zmq::socket socket;
 
-    virtual bool bind(socket& xpub, socket& xsub);
-    virtual bool unbind(socket& xpub, socket& xsub);
+    virtual bool bind(socket& publisher);
+    virtual bool unbind(socket& publisher);
+    virtual bool bind_batch(socket& publisher);
+    virtual bool unbind_batch(socket& publisher);
 
     // Implement the service.
     virtual void work() override;
 
+    // Publish queued transactions (integrated worker).
+    void publish(socket& publisher);
+
+    // Publish queued transaction batches (integrated worker).
+    void publish_batches(socket& publisher);
+
 private:
-    bool handle_transaction(const code& ec, transaction_const_ptr tx);
-    void publish_transaction(transaction_const_ptr tx);
+    bool bind(socket& publisher, const config::endpoint& service,
+        const std::string& feed);
+    bool unbind(socket& publisher, const std::string& feed);
+
+    bool enqueue(const data_chunk& tx_data);
+    bool enqueue_topics(const transaction_event& event);
+    void enqueue_batch(const data_chunk& tx_data);
+    int32_t expire_batch();
+    void flush_batch();
 
     const bool secure_;
     const bool verbose_;
+    const size_t batch_limit_;
+    const asio::duration batch_window_;
     const server::settings& settings_;
 
+    // These are protected by batch_mutex_.
+    data_stack batch_;
+    asio::steady_clock::time_point batch_started_;
+    mutable shared_mutex batch_mutex_;
+
     // These are thread safe.
+    publish_queue queue_;
+    publish_queue batch_queue_;
     bc::protocol::zmq::authenticator& authenticator_;
-    server_node& node_;
+    wakeup wakeup_;
 };
 
 } // namespace server
@@ -42,21 +42,36 @@ public:
     bool secure_only;
 
     uint16_t query_workers;
+    uint16_t heavy_query_workers;
+    uint16_t heavy_query_limit;
+    uint32_t query_rate_limit;
+    uint32_t query_rate_burst;
+    uint32_t response_cache_megabytes;
+    uint32_t publish_queue_limit;
     uint32_t subscription_limit;
     uint32_t subscription_expiration_minutes;
     uint32_t heartbeat_interval_seconds;
     bool block_service_enabled;
+    bool block_encoding_topics;
     bool transaction_service_enabled;
+    bool transaction_address_topics;
+    uint32_t transaction_batch_limit;
+    uint32_t transaction_batch_microseconds;
+    bool statistics_service_enabled;
 
     config::endpoint public_query_endpoint;
     config::endpoint public_heartbeat_endpoint;
     config::endpoint public_block_endpoint;
     config::endpoint public_transaction_endpoint;
+    config::endpoint public_transaction_batch_endpoint;
 
     config::endpoint secure_query_endpoint;
     config::endpoint secure_heartbeat_endpoint;
     config::endpoint secure_block_endpoint;
     config::endpoint secure_transaction_endpoint;
+    config::endpoint secure_transaction_batch_endpoint;
+
+    config::endpoint statistics_endpoint;
 
     config::sodium server_private_key;
     config::sodium::list client_public_keys;
@@ -66,6 +81,8 @@ public:
     /// Helpers.
     asio::duration heartbeat_interval() const;
     asio::duration subscription_expiration() const;
+    asio::duration transaction_batch_window() const;
+    size_t response_cache_size() const;
 };
 
 } // namespace server
@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_BLOCK_EVENT_HPP
+#define LIBBITCOIN_SERVER_BLOCK_EVENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// A block accepted into the long chain, shared by all of the server's block
+/// publishers and address notifiers. Each derivation of the block is computed
+/// once, upon first use by any of them, and unused derivations are never
+/// computed.
+class BCS_API block_event
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<const block_event> ptr;
+    typedef std::vector<ptr> list;
+
+    /// A payment address hash or stealth prefix of a transaction, the
+    /// fixed-width key on which address subscriptions are matched.
+    struct BCS_API key
+    {
+        /// The key bytes, in order of matching.
+        data_slice slice() const;
+
+        uint8_t size;
+        short_hash bytes;
+    };
+
+    typedef std::vector<key> key_list;
+
+    /// Extract the address and stealth keys of the transaction.
+    static void extract(key_list& out, const chain::transaction& tx);
+
+    /// Construct an event for the block at the given height.
+    block_event(uint32_t height, block_const_ptr block);
+
+    /// The height of the block.
+    uint32_t height() const;
+
+    /// The hash of the block.
+    const hash_digest& hash() const;
+
+    /// The block.
+    block_const_ptr block() const;
+
+    /// The canonical serialization of the block.
+    const data_chunk& data() const;
+
+    /// The serialization of the header, within that of the block.
+    data_slice header_data() const;
+
+    /// The concatenated hashes of the block's transactions, in block order.
+    const data_chunk& transaction_hashes() const;
+
+    /// The serialization of the indexed transaction, within that of the block.
+    data_slice transaction_data(size_t index) const;
+
+    /// The address and stealth keys of the indexed transaction.
+    const key_list& keys(size_t index) const;
+
+private:
+    void serialize() const;
+
+    const uint32_t height_;
+    const hash_digest hash_;
+    const block_const_ptr block_;
+
+    // These are computed once, guarded by their flags.
+    mutable std::once_flag serialized_;
+    mutable data_chunk data_;
+    mutable std::vector<size_t> offsets_;
+    mutable std::once_flag hashed_;
+    mutable data_chunk hashes_;
+    mutable std::unique_ptr<std::once_flag[]> extracted_;
+    mutable std::vector<key_list> keys_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_CHAIN_TIP_HPP
+#define LIBBITCOIN_SERVER_CHAIN_TIP_HPP
+
+#include <cstddef>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// The top block of the chain, published atomically as an immutable state so
+/// that readers never block or observe a partial update.
+class BCS_API chain_tip
+  : noncopyable
+{
+public:
+    struct state
+    {
+        size_t height;
+        hash_digest hash;
+
+        /// The serialized header, as sent in a block header response.
+        data_chunk header;
+    };
+
+    typedef std::shared_ptr<const state> ptr;
+
+    /// The current tip, or nullptr if not yet known.
+    ptr get() const;
+
+    /// Publish the tip, replacing any prior tip.
+    void set(size_t height, const chain::header& header);
+
+    /// Publish the tip only if there is not yet a tip.
+    void initialize(size_t height, const chain::header& header);
+
+private:
+    static ptr create(size_t height, const chain::header& header);
+
+    // This is accessed only by atomic load and store.
+    ptr state_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
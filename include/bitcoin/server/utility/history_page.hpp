@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_HISTORY_PAGE_HPP
+#define LIBBITCOIN_SERVER_HISTORY_PAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is not thread safe.
+/// The selection of a page of address history following the last row of the
+/// prior page. History is ordered newest first, so rows confirmed between page
+/// requests precede the cursor row and do not shift the page.
+class BCS_API history_page
+{
+public:
+    /// The last row of a page, after which the next page begins. The offset
+    /// is the row's position when sent, a hint to limit the fetch.
+    struct BCS_API cursor
+    {
+        /// The serialized size of a cursor.
+        static const size_t size;
+
+        /// Deserialize the cursor, false if the data is not of cursor size.
+        bool from_data(const data_chunk& data);
+
+        /// Serialize the cursor.
+        data_chunk to_data() const;
+
+        /// True if the cursor begins the history (zero cursor).
+        bool first() const;
+
+        uint32_t offset;
+        uint32_t height;
+        uint8_t kind;
+        hash_digest hash;
+        uint32_t index;
+    };
+
+    /// Construct a selection of up to rows following the position.
+    history_page(const cursor& position, size_t rows);
+
+    /// The row limit for the history fetch, which allows for up to a page of
+    /// rows confirmed since the cursor was sent.
+    size_t limit() const;
+
+    /// Select the page from the history fetched with the limit (zero for all
+    /// rows), false if the limit excluded rows of the page.
+    bool select(const chain::history_compact::list& history, size_t limit);
+
+    /// The position of the first selected row.
+    size_t start() const;
+
+    /// The position following the last selected row.
+    size_t end() const;
+
+    /// The number of selected rows.
+    size_t count() const;
+
+    /// The cursor of the last selected row, zero if no rows follow it.
+    cursor next(const chain::history_compact::list& history) const;
+
+private:
+    size_t locate(const chain::history_compact::list& history) const;
+
+    const cursor position_;
+    const size_t rows_;
+    size_t start_;
+    size_t end_;
+    bool more_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_LATENCY_HISTOGRAM_HPP
+#define LIBBITCOIN_SERVER_LATENCY_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// A lock-free histogram of latencies in power-of-two microsecond buckets.
+/// Bucket zero counts latencies under two microseconds, and bucket n counts
+/// latencies in [2^n, 2^(n+1)) microseconds, with the last unbounded.
+class BCS_API latency_histogram
+  : noncopyable
+{
+public:
+    static constexpr size_t bucket_count = 32;
+    typedef asio::steady_clock::time_point time_point;
+
+    /// The current time, for use as a start time.
+    static time_point now();
+
+    /// Construct an empty histogram.
+    latency_histogram();
+
+    /// Count the latency in its bucket (relaxed, callable from any thread).
+    void record(const asio::duration& latency);
+
+    /// Count the latency from the start time to now.
+    void record_since(const time_point& start);
+
+    /// The number of recorded latencies.
+    uint64_t count() const;
+
+    /// Write the histogram in text exposition format, labels are preformatted.
+    void report(std::ostream& output, const std::string& name,
+        const std::string& labels) const;
+
+private:
+    static size_t bucket(uint64_t microseconds);
+
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> total_microseconds_;
+    std::array<std::atomic<uint64_t>, bucket_count> buckets_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_MPSC_QUEUE_HPP
+#define LIBBITCOIN_SERVER_MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe for any number of producers and one consumer.
+/// Unbounded lock-free multiple-producer single-consumer queue (Vyukov).
+/// Push may be called from any thread, pop only from the consumer thread.
+template <typename Item>
+class mpsc_queue
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<mpsc_queue<Item>> ptr;
+
+    /// Construct an empty queue.
+    mpsc_queue();
+
+    /// Destroy all items remaining in the queue.
+    ~mpsc_queue();
+
+    /// Append an item to the queue (any thread).
+    void push(Item&& item);
+
+    /// Move the oldest item into out, false if empty (consumer thread only).
+    bool pop(Item& out);
+
+    /// The number of items pushed and not yet popped.
+    size_t size() const;
+
+    /// True if there are no items pushed and not yet popped.
+    bool empty() const;
+
+private:
+    typedef typename std::aligned_storage<sizeof(Item),
+        std::alignment_of<Item>::value>::type storage;
+
+    struct node
+    {
+        std::atomic<node*> next;
+        storage item;
+    };
+
+    static Item& item(node* value);
+
+    // The most recently pushed node, exchanged by producers.
+    std::atomic<node*> head_;
+
+    // The sentinel preceding the oldest item, touched only by the consumer.
+    node* tail_;
+
+    std::atomic<size_t> size_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#include <bitcoin/server/impl/utility/mpsc_queue.ipp>
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_PREFIX_TRIE_HPP
+#define LIBBITCOIN_SERVER_PREFIX_TRIE_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is not thread safe.
+/// A bitwise prefix trie of values keyed on binary prefixes. Matching a field
+/// visits only the values whose prefix is a prefix of the field, at a cost
+/// proportional to the field length and the number of matches.
+template <typename Value>
+class prefix_trie
+  : noncopyable
+{
+public:
+    /// Construct an empty trie.
+    prefix_trie();
+
+    /// The number of values in the trie.
+    size_t size() const;
+
+    /// True if there are no values in the trie.
+    bool empty() const;
+
+    /// Add the value under the prefix, alongside any others of the prefix.
+    void insert(const binary& prefix, const Value& value);
+
+    /// Obtain the first value of the prefix satisfying the predicate, or a
+    /// default constructed value if there is none.
+    template <typename Predicate>
+    Value find(const binary& prefix, Predicate predicate) const;
+
+    /// Remove the values of the prefix satisfying the predicate.
+    template <typename Predicate>
+    size_t remove(const binary& prefix, Predicate predicate);
+
+    /// Remove all values satisfying the predicate, which may act upon them.
+    template <typename Predicate>
+    size_t remove_if(Predicate predicate);
+
+    /// Invoke the visitor for each value with a prefix of the field, in order
+    /// of increasing prefix length. The field is a fixed-width key of whole
+    /// bytes, read in place with the bit order of binary, so matching does
+    /// not allocate.
+    template <typename Visitor>
+    void match(const data_slice& field, Visitor visitor) const;
+
+private:
+    struct node
+    {
+        std::array<std::unique_ptr<node>, 2> children;
+        std::vector<Value> values;
+    };
+
+    template <typename Predicate>
+    static size_t erase(std::vector<Value>& values, Predicate predicate);
+
+    template <typename Predicate>
+    static size_t remove_if(node& parent, Predicate predicate);
+
+    static bool barren(const node& value);
+    const node* locate(const binary& prefix) const;
+
+    node root_;
+    size_t size_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#include <bitcoin/server/impl/utility/prefix_trie.ipp>
+
+#endif
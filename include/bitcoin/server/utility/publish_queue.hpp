@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_PUBLISH_QUEUE_HPP
+#define LIBBITCOIN_SERVER_PUBLISH_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/utility/mpsc_queue.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe for any number of producers and one consumer.
+/// A bounded queue of messages awaiting a single long-lived publisher. When
+/// the queue is full new messages are dropped and counted, as the publisher
+/// would otherwise drop them at high water.
+class BCS_API publish_queue
+  : noncopyable
+{
+public:
+    /// Construct a queue for the named service and topic (zero is unbounded).
+    publish_queue(const std::string& service, const std::string& topic,
+        size_t limit);
+
+    /// Queue the message, false if dropped because full (any thread).
+    bool push(bc::protocol::zmq::message&& message);
+
+    /// Move the oldest message into out, false if empty (publisher only).
+    bool pop(bc::protocol::zmq::message& out);
+
+    /// The number of messages queued and not yet popped.
+    size_t depth() const;
+
+    /// The number of messages dropped because the queue was full.
+    uint64_t dropped() const;
+
+    /// Write the queue counters in text exposition format.
+    void report(std::ostream& output) const;
+
+private:
+    const std::string labels_;
+    const size_t limit_;
+    std::atomic<uint64_t> queued_;
+    std::atomic<uint64_t> dropped_;
+    mpsc_queue<bc::protocol::zmq::message> queue_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_QUERY_COALESCER_HPP
+#define LIBBITCOIN_SERVER_QUERY_COALESCER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Coalesce concurrent identical queries (same command and payload) into a
+/// single execution, with its response copied to each waiting route. This is
+/// valid only for read-only commands that send exactly one response, and a
+/// waiter may receive a result that was in flight when it was queried.
+class BCS_API query_coalescer
+  : noncopyable
+{
+public:
+    typedef std::function<void(const message&, send_handler)> command_handler;
+
+    /// Execute the query, or wait on an identical query in flight.
+    void execute(const message& request, send_handler handler,
+        command_handler command);
+
+private:
+    struct key
+    {
+        bool operator==(const key& other) const;
+
+        std::string command;
+        data_chunk data;
+    };
+
+    struct key_hasher
+    {
+        size_t operator()(const key& value) const;
+    };
+
+    typedef std::pair<message, send_handler> waiter;
+    typedef std::vector<waiter> waiters;
+    typedef std::unordered_map<key, waiters, key_hasher> map;
+
+    void complete(const key& query, message&& response,
+        send_handler handler);
+
+    // This is protected by mutex.
+    map pending_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_QUERY_STATISTICS_HPP
+#define LIBBITCOIN_SERVER_QUERY_STATISTICS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/utility/latency_histogram.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Request counters and latency histograms for each command of one query
+/// service (secure or public). Commands are registered as they are attached,
+/// after which each recording is lock free.
+class BCS_API query_statistics
+  : noncopyable
+{
+public:
+    /// This class is thread safe.
+    struct BCS_API command
+      : noncopyable
+    {
+        typedef std::shared_ptr<command> ptr;
+
+        command();
+
+        std::atomic<uint64_t> requests;
+        std::atomic<uint64_t> errors;
+        std::atomic<uint64_t> received_bytes;
+        std::atomic<uint64_t> sent_bytes;
+
+        /// From dispatch of the query to each response (fetch and serialize).
+        latency_histogram execute;
+
+        /// From queueing of each response to its send by the worker thread.
+        latency_histogram send_wait;
+    };
+
+    /// Construct statistics for the named service ("secure" or "public").
+    query_statistics(const std::string& service);
+
+    /// Obtain the statistics of the command, adding them if not yet present.
+    command::ptr attach(const std::string& command);
+
+    /// Write all command statistics in text exposition format.
+    void report(std::ostream& output) const;
+
+private:
+    typedef std::map<std::string, command::ptr> command_map;
+
+    const std::string service_;
+
+    // This is protected by mutex.
+    command_map commands_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
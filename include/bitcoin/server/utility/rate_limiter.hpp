@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_RATE_LIMITER_HPP
+#define LIBBITCOIN_SERVER_RATE_LIMITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is not thread safe.
+/// A token bucket for each client identity. Each bucket refills at the rate
+/// up to the burst, and each admitted request consumes one token. A new
+/// identity starts with a full bucket, so a client that obtains a new identity
+/// (such as by reconnecting) is not limited by its prior requests. The number
+/// of buckets is limited, and once reached new identities share one bucket.
+class BCS_API rate_limiter
+{
+public:
+    /// The default maximum number of client buckets.
+    static const size_t default_clients;
+
+    /// Construct a limiter, a zero rate disables limiting.
+    rate_limiter(uint32_t rate_per_second, uint32_t burst,
+        size_t clients=default_clients);
+
+    /// True if the limiter admits all requests.
+    bool disabled() const;
+
+    /// Consume a token of the client, false if none is available.
+    bool admit(const data_chunk& identity);
+
+private:
+    typedef asio::steady_clock::time_point time_point;
+
+    struct bucket
+    {
+        double tokens;
+        time_point updated;
+    };
+
+    struct identity_hasher
+    {
+        size_t operator()(const data_chunk& value) const;
+    };
+
+    typedef std::unordered_map<data_chunk, bucket, identity_hasher> map;
+
+    void refill(bucket& value, const time_point& now) const;
+    void purge(const time_point& now);
+
+    bool consume(bucket& value, const time_point& now) const;
+
+    const double rate_;
+    const double burst_;
+    const size_t clients_;
+
+    // Buckets are purged once refilled, after as many admissions as clients.
+    size_t admissions_;
+    map buckets_;
+
+    // Identities without a bucket share this one while all are in use.
+    bucket shared_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
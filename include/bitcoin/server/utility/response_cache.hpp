@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_RESPONSE_CACHE_HPP
+#define LIBBITCOIN_SERVER_RESPONSE_CACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// A sharded least-recently-used cache of serialized query responses. Each
+/// response is keyed on a block or transaction hash and remains valid until
+/// the block that it derives from is reorganized out of the chain.
+class BCS_API response_cache
+  : noncopyable
+{
+public:
+    /// The cached query types, each of which is keyed on a hash.
+    enum class kind : uint8_t
+    {
+        block_header,
+        block_transaction_hashes,
+        transaction,
+        transaction_index
+    };
+
+    /// Construct a cache of the given payload size in bytes (zero disables).
+    response_cache(size_t capacity);
+
+    /// True if the cache has no capacity.
+    bool disabled() const;
+
+    /// The invalidation counter, captured before a fetch and passed to store.
+    size_t generation() const;
+
+    /// Obtain a cached response payload, and mark it as recently used.
+    bool find(data_chunk& out_payload, kind type, const hash_digest& hash);
+
+    /// Cache a response payload unless invalidated since generation.
+    void store(kind type, const hash_digest& hash, const data_chunk& payload,
+        size_t generation);
+
+    /// Remove all responses derived from the blocks or their transactions.
+    void invalidate(const block_const_ptr_list& blocks);
+
+private:
+    static constexpr size_t shard_count = 16;
+
+    struct key
+    {
+        bool operator==(const key& other) const;
+
+        kind type;
+        hash_digest hash;
+    };
+
+    struct key_hasher
+    {
+        size_t operator()(const key& value) const;
+    };
+
+    typedef std::list<key> recency;
+
+    struct entry
+    {
+        data_chunk payload;
+        recency::iterator position;
+    };
+
+    typedef std::unordered_map<key, entry, key_hasher> map;
+
+    struct shard
+    {
+        size_t size;
+        recency order;
+        map entries;
+        mutable shared_mutex mutex;
+    };
+
+    static size_t cost(const data_chunk& payload);
+    shard& locate(const key& value);
+    void remove(const key& value);
+    void erase(shard& partition, map::iterator it);
+
+    const size_t shard_capacity_;
+    std::atomic<size_t> generation_;
+    std::array<shard, shard_count> shards_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_TIMER_WHEEL_HPP
+#define LIBBITCOIN_SERVER_TIMER_WHEEL_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is not thread safe.
+/// A hierarchical timer wheel of values, each due at a point in time. Each
+/// level has 64 slots of 64 times the span of the level below, so with four
+/// levels a value may be due up to 2^24 ticks out, beyond which it is due at
+/// that limit. Scheduling is constant time and each tick of advance visits
+/// only the values due on it, or cascading toward it from a higher level.
+template <typename Value>
+class timer_wheel
+  : noncopyable
+{
+public:
+    typedef asio::steady_clock::time_point time_point;
+
+    /// Construct an empty wheel starting now, with the given tick duration.
+    timer_wheel(const asio::duration& tick);
+
+    /// The number of scheduled values.
+    size_t size() const;
+
+    /// Schedule the value to be due at the given time (no sooner than the
+    /// next tick).
+    void schedule(const time_point& due, const Value& value);
+
+    /// Advance the wheel to the given time, invoking the handler for each
+    /// value now due. The handler may schedule values.
+    template <typename Handler>
+    void advance(const time_point& now, Handler handler);
+
+private:
+    static constexpr size_t level_bits = 6;
+    static constexpr size_t slot_count = size_t(1) << level_bits;
+    static constexpr size_t level_count = 4;
+    static constexpr uint64_t slot_mask = slot_count - 1;
+    static constexpr uint64_t horizon = uint64_t(1) <<
+        (level_bits * level_count);
+
+    struct entry
+    {
+        uint64_t tick;
+        Value value;
+    };
+
+    typedef std::vector<entry> slot;
+    typedef std::array<slot, slot_count> level;
+
+    uint64_t to_tick(const time_point& time, bool round_up) const;
+    void insert(entry&& value);
+
+    const asio::duration tick_;
+    const time_point start_;
+    uint64_t current_;
+    size_t size_;
+    std::array<level, level_count> levels_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#include <bitcoin/server/impl/utility/timer_wheel.ipp>
+
+#endif
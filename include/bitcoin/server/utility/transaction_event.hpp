@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_TRANSACTION_EVENT_HPP
+#define LIBBITCOIN_SERVER_TRANSACTION_EVENT_HPP
+
+#include <memory>
+#include <mutex>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/utility/block_event.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// A transaction accepted into the memory pool, shared by all of the server's
+/// transaction publishers and address notifiers. As with blocks, each
+/// derivation is computed once, upon first use by any of them.
+class BCS_API transaction_event
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<const transaction_event> ptr;
+
+    /// Construct an event for the transaction.
+    transaction_event(transaction_const_ptr tx);
+
+    /// The transaction.
+    transaction_const_ptr transaction() const;
+
+    /// The canonical serialization of the transaction.
+    const data_chunk& data() const;
+
+    /// The address and stealth keys of the transaction.
+    const block_event::key_list& keys() const;
+
+private:
+    const transaction_const_ptr tx_;
+
+    // These are computed once, guarded by their flags.
+    mutable std::once_flag serialized_;
+    mutable data_chunk data_;
+    mutable std::once_flag extracted_;
+    mutable block_event::key_list keys_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
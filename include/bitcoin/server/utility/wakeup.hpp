@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_WAKEUP_HPP
+#define LIBBITCOIN_SERVER_WAKEUP_HPP
+
+#include <atomic>
+#include <memory>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// An inprocess signal that wakes a worker blocked on its poller when work is
+/// queued for it by other threads. At most one signal is pending at a time,
+/// so notification costs only an atomic exchange while the worker is awake.
+class BCS_API wakeup
+  : noncopyable
+{
+public:
+    /// Construct a signal in the context of the authenticator.
+    wakeup(bc::protocol::zmq::authenticator& authenticator);
+
+    /// Bind the receiver and connect the sender (worker thread only).
+    bool start(bc::protocol::zmq::socket& receiver);
+
+    /// Close the sender and receiver, after which notify is ignored (worker
+    /// thread only).
+    bool stop(bc::protocol::zmq::socket& receiver);
+
+    /// Consume the pending signal, call before taking queued work (worker
+    /// thread only, when the receiver is signaled).
+    void clear(bc::protocol::zmq::socket& receiver);
+
+    /// Wake the worker if not already signaled (any thread).
+    void notify();
+
+private:
+    typedef std::shared_ptr<bc::protocol::zmq::socket> socket_ptr;
+
+    const config::endpoint endpoint_;
+    bc::protocol::zmq::authenticator& authenticator_;
+    std::atomic<bool> pending_;
+
+    // This is protected by mutex.
+    socket_ptr sender_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -21,12 +21,18 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/messages/route.hpp>
 #include <bitcoin/server/settings.hpp>
-#include <bitcoin/server/utility/address_key.hpp>
+#include <bitcoin/server/utility/block_event.hpp>
+#include <bitcoin/server/utility/transaction_event.hpp>
+#include <bitcoin/server/utility/mpsc_queue.hpp>
+#include <bitcoin/server/utility/prefix_trie.hpp>
+#include <bitcoin/server/utility/timer_wheel.hpp>
+#include <bitcoin/server/utility/wakeup.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -41,6 +47,22 @@ class BCS_API notification_worker
 public:
     typedef std::shared_ptr<notification_worker> ptr;
 
+    /// The notification of a subscription to matched block transactions.
+    /// Unconfirmed transactions are always notified individually.
+    enum class mode : uint8_t
+    {
+        /// One address.update2 message for each matched transaction.
+        transaction = 0,
+
+        /// One address.digest_update message for each block, with the
+        /// matched transactions.
+        block_transactions = 1,
+
+        /// One address.digest_update message for each block, with the
+        /// hashes of the matched transactions.
+        block_hashes = 2
+    };
+
     /// Construct an address worker.
     notification_worker(bc::protocol::zmq::authenticator& authenticator,
         server_node& node, bool secure);
@@ -51,9 +73,17 @@ public:
     /// Stop the worker.
     bool stop() override;
 
-    /// Subscribe to address and stealth prefix notifications.
+    /// Subscribe to address and stealth prefix notifications, expiring after
+    /// the requested seconds (zero or above the configured limit is limited).
     virtual code subscribe_address(const route& reply_to, uint32_t id,
-        const binary& prefix_filter, bool unsubscribe);
+        const binary& prefix_filter, uint32_t ttl_seconds, mode delivery,
+        bool unsubscribe);
+
+    /// Notify subscribers of the blocks accepted into the long chain.
+    virtual void notify_blocks(const block_event::list& events);
+
+    /// Notify subscribers of the transaction accepted into the pool.
+    virtual void notify_transaction(const transaction_event& event);
 
 protected:
     typedef bc::protocol::zmq::socket socket;
@@ -65,42 +95,78 @@ protected:
     virtual void work() override;
 
 private:
-    typedef std::shared_ptr<uint16_t> sequence_ptr;
-    typedef notifier<address_key, const code&, const binary&, uint32_t,
-        const hash_digest&, transaction_const_ptr> address_subscriber;
-
-    // Remove expired subscriptions.
+    class transaction_suffix;
+    class block_matches;
+
+    // An address or stealth prefix subscription, renewed by resubscription.
+    // The expiration wheel holds the subscription until the scheduled time,
+    // at which it is removed or, if since renewed, rescheduled.
+    struct subscription
+    {
+        route reply_to;
+        uint32_t id;
+        binary prefix_filter;
+        uint16_t sequence;
+        mode delivery;
+        asio::steady_clock::time_point expires;
+        asio::steady_clock::time_point scheduled;
+        bool removed;
+    };
+
+    typedef std::shared_ptr<subscription> subscription_ptr;
+    typedef std::vector<subscription_ptr> subscription_list;
+
+    // Remove subscriptions expired since the last purge.
     void purge();
-    int32_t purge_interval_milliseconds() const;
 
-    bool handle_reorganization(const code& ec, size_t fork_height,
-        block_const_ptr_list_const_ptr new_blocks,
-        block_const_ptr_list_const_ptr old_blocks);
-    bool handle_transaction_pool(const code& ec, transaction_const_ptr tx);
+    // Remove the subscription from the index (caller must lock).
+    void remove(const subscription_ptr& subscriber);
+
+    // True if there are no subscriptions.
+    bool unsubscribed() const;
 
-    void notify_block(uint32_t height, block_const_ptr block);
-    void notify_transaction(uint32_t height, const hash_digest& block_hash,
-        transaction_const_ptr tx);
+    void notify_block(block_event::ptr event);
 
-    void notify_address(const binary& field, uint32_t height,
-        const hash_digest& block_hash, transaction_const_ptr tx);
+    // Collect the subscriptions matched by any address key of the tx.
+    void match(subscription_list& out,
+        const block_event::key_list& keys) const;
 
-    // Send a notification to the subscriber.
+    // Queue a notification of the transaction to each matched subscriber.
+    void notify(const subscription_list& matches, uint32_t height,
+        const hash_digest& block_hash, const data_slice& tx_data);
+
+    // Queue a notification to the subscriber.
     void send(const route& reply_to, const std::string& command,
-        uint32_t id, const data_chunk& payload);
+        uint32_t id, data_chunk&& payload);
+
+    // Send queued notifications (worker thread only).
+    void deliver(socket& router);
+
+    // Queue a notification of the matched transaction to the subscriber.
+    void notify(subscription& subscriber, transaction_suffix& suffix);
 
-    bool handle_address(const code& ec, const binary& field, uint32_t height,
-        const hash_digest& block_hash, transaction_const_ptr tx,
-        const route& reply_to, uint32_t id, const binary& prefix_filter,
-        sequence_ptr sequence);
+    // Queue a notification of the block's matched transactions.
+    void notify(subscription& subscriber, const block_event& event,
+        const std::vector<size_t>& matched);
+
+    // Queue a final notification of the code to the removed subscriber.
+    void notify(const subscription& subscriber, const code& ec);
 
     const bool secure_;
     const server::settings& settings_;
 
     // These are thread safe.
-    server_node& node_;
     bc::protocol::zmq::authenticator& authenticator_;
-    address_subscriber::ptr address_subscriber_;
+    dispatcher dispatch_;
+
+    // These are protected by mutex.
+    prefix_trie<subscription_ptr> subscriptions_;
+    timer_wheel<subscription_ptr> expirations_;
+    mutable shared_mutex mutex_;
+
+    // These are thread safe, only the worker thread pops notifications.
+    mpsc_queue<message> notifications_;
+    wakeup wakeup_;
 };
 
 } // namespace server
@@ -19,6 +19,8 @@
 #ifndef LIBBITCOIN_SERVER_QUERY_WORKER_HPP
 #define LIBBITCOIN_SERVER_QUERY_WORKER_HPP
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
 #include <functional>
 #include <string>
@@ -27,6 +29,10 @@
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/latency_histogram.hpp>
+#include <bitcoin/server/utility/mpsc_queue.hpp>
+#include <bitcoin/server/utility/query_statistics.hpp>
+#include <bitcoin/server/utility/wakeup.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -41,9 +47,9 @@ class BCS_API query_worker
 public:
     typedef std::shared_ptr<query_worker> ptr;
 
-    /// Construct a query worker.
+    /// Construct a query worker, for the heavy or default cost class.
     query_worker(bc::protocol::zmq::authenticator& authenticator,
-        server_node& node, bool secure);
+        server_node& node, bool secure, bool heavy=false);
 
 protected:
     typedef bc::protocol::zmq::socket socket;
@@ -53,16 +59,34 @@ protected:
 
     virtual void attach_interface();
     virtual void attach(const std::string& command, command_handler handler);
+    virtual command_handler coalesce(command_handler handler);
 
     virtual bool connect(socket& router);
     virtual bool disconnect(socket& router);
     virtual void query(socket& router);
+    virtual void respond(socket& router);
 
     // Implement the worker.
     virtual void work();
 
 private:
+    class query_completion;
+
+    // A response is queued with its statistics and the time it was queued.
+    struct queued_response
+    {
+        message response;
+        query_statistics::command::ptr statistics;
+        latency_histogram::time_point queued;
+    };
+
+    typedef mpsc_queue<queued_response> response_queue;
+    typedef std::shared_ptr<wakeup> wakeup_ptr;
+    typedef std::unordered_map<std::string, query_statistics::command::ptr>
+        statistics_map;
+
     const bool secure_;
+    const bool heavy_;
     const bool verbose_;
     const server::settings& settings_;
 
@@ -70,8 +94,14 @@ private:
     server_node& node_;
     bc::protocol::zmq::authenticator& authenticator_;
 
-    // This is protected by base class mutex.
+    // These are protected by base class mutex.
     command_map command_handlers_;
+    statistics_map command_statistics_;
+
+    // These are thread safe, and outlive the worker in pending completions.
+    // Only the worker thread pops responses, so only it touches the socket.
+    response_queue::ptr responses_;
+    wakeup_ptr wakeup_;
 };
 
 } // namespace server
@@ -35,8 +35,11 @@ void address::subscribe2(server_node& node, const message& request,
     send_handler handler)
 {
     binary prefix_filter;
+    uint32_t ttl_seconds;
+    notification_worker::mode delivery;
 
-    if (!unwrap_subscribe2_args(prefix_filter, request))
+    if (!unwrap_subscribe2_args(prefix_filter, ttl_seconds, delivery,
+        request))
     {
         handler(message(request, error::bad_stream));
         return;
@@ -44,7 +47,7 @@ void address::subscribe2(server_node& node, const message& request,
 
     // May cause a notification to fire in addition to the response below.
     const auto ec = node.subscribe_address(request.route(), request.id(),
-        prefix_filter, false);
+        prefix_filter, ttl_seconds, delivery, false);
 
     handler(message(request, ec));
 }
@@ -53,8 +56,11 @@ void address::unsubscribe2(server_node& node, const message& request,
     send_handler handler)
 {
     binary prefix_filter;
+    uint32_t ttl_seconds;
+    notification_worker::mode delivery;
 
-    if (!unwrap_subscribe2_args(prefix_filter, request))
+    if (!unwrap_subscribe2_args(prefix_filter, ttl_seconds, delivery,
+        request))
     {
         handler(message(request, error::bad_stream));
         return;
@@ -62,16 +68,24 @@ void address::unsubscribe2(server_node& node, const message& request,
 
     // May cause a notification to fire in addition to the response below.
     const auto ec = node.subscribe_address(request.route(), request.id(),
-        prefix_filter, true);
+        prefix_filter, ttl_seconds, delivery, true);
 
     handler(message(request, ec));
 }
 
 bool address::unwrap_subscribe2_args(binary& prefix_filter,
+    uint32_t& ttl_seconds, notification_worker::mode& delivery,
     const message& request)
 {
+    static constexpr auto ttl_length = sizeof(uint32_t);
+    static constexpr auto mode_length = sizeof(uint8_t);
+    static constexpr auto maximum_mode = static_cast<uint8_t>(
+        notification_worker::mode::block_hashes);
+
     // [ prefix_bitsize:1 ]
     // [ prefix_blocks:...]
+    // [ ttl_seconds:4 ] (optional)
+    // [ mode:1 ] (optional, requires ttl_seconds)
     const auto& data = request.data();
 
     if (data.empty())
@@ -79,12 +93,35 @@ bool address::unwrap_subscribe2_args(binary& prefix_filter,
 
     const auto bit_length = data[0];
     const auto byte_length = binary::blocks_size(bit_length);
+    const auto args_length = data.size() - 1;
 
-    if (byte_length > short_hash_size || (data.size() - 1) != byte_length)
+    if (byte_length > short_hash_size || (args_length != byte_length &&
+        args_length != byte_length + ttl_length &&
+        args_length != byte_length + ttl_length + mode_length))
         return false;
 
-    const data_chunk bytes({ data.begin() + 1, data.end() });
+    const auto blocks_end = data.begin() + 1 + byte_length;
+    const data_chunk bytes({ data.begin() + 1, blocks_end });
     prefix_filter = binary(bit_length, bytes);
+
+    // Zero requests the configured expiration.
+    ttl_seconds = 0;
+    delivery = notification_worker::mode::transaction;
+    auto deserial = make_safe_deserializer(blocks_end, data.end());
+
+    if (args_length > byte_length)
+        ttl_seconds = deserial.read_4_bytes_little_endian();
+
+    if (args_length > byte_length + ttl_length)
+    {
+        const auto value = deserial.read_byte();
+
+        if (value > maximum_mode)
+            return false;
+
+        delivery = static_cast<notification_worker::mode>(value);
+    }
+
     return true;
 }
 
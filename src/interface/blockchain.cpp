@@ -21,10 +21,14 @@
 #include <cstdint>
 #include <cstddef>
 #include <functional>
+#include <memory>
+#include <utility>
 #include <bitcoin/blockchain.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/utility/history_page.hpp>
+#include <bitcoin/server/utility/response_cache.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -38,15 +42,85 @@ static constexpr size_t code_size = sizeof(uint32_t);
 static constexpr size_t index_size = sizeof(uint32_t);
 static constexpr size_t point_size = hash_size + sizeof(uint32_t);
 static constexpr auto canonical = bc::message::version::level::canonical;
+static constexpr size_t history_row_size = sizeof(uint8_t) + point_size +
+    sizeof(uint32_t) + sizeof(uint64_t);
+static constexpr size_t history_args_size = sizeof(uint8_t) +
+    short_hash_size + sizeof(uint32_t);
 
+// The maximum number of addresses in a fetch_history3 request.
+static constexpr size_t max_history_batch = 1000;
+
+// The maximum (and default) number of rows in a fetch_history4 page.
+static constexpr size_t max_history_page = 10000;
+
+// TODO: add serialization to history_compact.
+static void write_history(writer& serial,
+    history_compact::list::const_iterator begin,
+    history_compact::list::const_iterator end)
+{
+    for (auto row = begin; row != end; ++row)
+    {
+        BITCOIN_ASSERT(row->height <= max_uint32);
+        serial.write_byte(static_cast<uint8_t>(row->kind));
+        serial.write_bytes(row->point.to_data());
+        serial.write_4_bytes_little_endian(row->height);
+        serial.write_8_bytes_little_endian(row->value);
+    }
+}
+
+// Response cache.
+// ----------------------------------------------------------------------------
+
+// Send the cached response for the hash if there is one.
+bool blockchain::cached(server_node& node, response_cache::kind type,
+    const hash_digest& hash, const message& request, send_handler handler)
+{
+    data_chunk payload;
+
+    if (!node.cache().find(payload, type, hash))
+        return false;
+
+    handler(message(request, std::move(payload)));
+    return true;
+}
+
+// Cache the successful response before sending it.
+// The generation is captured here so that a reorganization during the fetch
+// precludes caching of a response derived from a block no longer in the chain.
+send_handler blockchain::cache_handler(server_node& node,
+    response_cache::kind type, const hash_digest& hash, send_handler handler)
+{
+    auto& cache = node.cache();
+
+    if (cache.disabled())
+        return handler;
+
+    const auto generation = cache.generation();
+
+    return [&cache, type, hash, generation, handler](message&& response)
+    {
+        const auto& payload = response.data();
+
+        if (payload.size() >= code_size)
+        {
+            auto deserial = make_safe_deserializer(payload.begin(),
+                payload.end());
+
+            if (!deserial.read_error_code())
+                cache.store(type, hash, payload, generation);
+        }
+
+        handler(std::move(response));
+    };
+}
+
+// Interface.
+// ----------------------------------------------------------------------------
 
 void blockchain::fetch_history2(server_node& node, const message& request,
     send_handler handler)
 {
     static constexpr size_t limit = 0;
-    static constexpr size_t history_args_size = sizeof(uint8_t) +
-        short_hash_size + sizeof(uint32_t);
-
     const auto& data = request.data();
 
     if (data.size() != history_args_size)
@@ -72,24 +146,169 @@ void blockchain::history_fetched(const code& ec,
     const history_compact::list& history, const message& request,
     send_handler handler)
 {
-    static constexpr size_t row_size = sizeof(uint8_t) + point_size +
-        sizeof(uint32_t) + sizeof(uint64_t);
+    data_chunk result(code_size + history_row_size * history.size());
+    auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(ec);
+    write_history(serial, history.begin(), history.end());
+    handler(message(request, std::move(result)));
+}
+
+// Rows are returned newest first, following the cursor row of the prior page.
+void blockchain::fetch_history4(server_node& node, const message& request,
+    send_handler handler)
+{
+    static const size_t page_args_size = history_args_size +
+        history_page::cursor::size + sizeof(uint32_t);
+
+    const auto& data = request.data();
+
+    if (data.size() != page_args_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // The version byte is not used.
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto version_byte = deserial.read_byte();
+    const auto hash = deserial.read_short_hash();
+    const size_t from_height = deserial.read_4_bytes_little_endian();
+
+    history_page::cursor cursor;
+    cursor.from_data(deserial.read_bytes(history_page::cursor::size));
+
+    const size_t requested = deserial.read_4_bytes_little_endian();
+    const payment_address address(hash, version_byte);
+    const auto rows = requested == 0 || requested > max_history_page ?
+        max_history_page : requested;
+
+    const history_page page(cursor, rows);
+    fetch_history_page(node, address, from_height, page, page.limit(),
+        request, handler);
+}
+
+void blockchain::fetch_history_page(server_node& node,
+    const payment_address& address, size_t from_height,
+    const history_page& page, size_t limit, const message& request,
+    send_handler handler)
+{
+    node.chain().fetch_history(address, limit, from_height,
+        std::bind(&blockchain::history_page_fetched,
+            _1, _2, std::ref(node), address, from_height, page, limit,
+                request, handler));
+}
+
+void blockchain::history_page_fetched(const code& ec,
+    const history_compact::list& history, server_node& node,
+    const payment_address& address, size_t from_height, history_page page,
+    size_t limit, const message& request, send_handler handler)
+{
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
 
-    data_chunk result(code_size + row_size * history.size());
+    // The limit excluded the cursor row or rows of the page, so fetch all.
+    if (!page.select(history, limit))
+    {
+        fetch_history_page(node, address, from_height, page, 0, request,
+            handler);
+        return;
+    }
+
+    const auto next = page.next(history).to_data();
+    const auto count = page.count();
+
+    // [ code:4 ]
+    // [ next_cursor:45 ] (zero if no rows follow)
+    // [ count:4 ]
+    // [[ row:49 ]...]
+    data_chunk result(code_size + next.size() + sizeof(uint32_t) +
+        history_row_size * count);
     auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(error::success);
+    serial.write_bytes(next);
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(count));
+    write_history(serial, history.begin() + page.start(),
+        history.begin() + page.end());
+    handler(message(request, std::move(result)));
+}
+
+void blockchain::fetch_history3(server_node& node, const message& request,
+    send_handler handler)
+{
+    static constexpr size_t limit = 0;
+    const auto& data = request.data();
+    const auto count = data.size() / history_args_size;
+
+    if (data.empty() || data.size() % history_args_size != 0 ||
+        count > max_history_batch)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // Each fetch populates its own result, the last to complete sends.
+    const auto results = std::make_shared<std::vector<history_result>>(count);
+    const result_handler complete = synchronize(
+        std::bind(&blockchain::history_batch_completed,
+            _1, results, request, handler),
+        count, "fetch_history3", synchronizer_terminate::on_count);
+
+    // The version byte is not used.
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        const auto version_byte = deserial.read_byte();
+        const auto hash = deserial.read_short_hash();
+        const size_t from_height = deserial.read_4_bytes_little_endian();
+        const payment_address address(hash, version_byte);
+
+        node.chain().fetch_history(address, limit, from_height,
+            std::bind(&blockchain::history_batch_fetched,
+                _1, _2, index, results, complete));
+    }
+}
+
+void blockchain::history_batch_fetched(const code& ec,
+    const history_compact::list& history, size_t index,
+    history_results results, result_handler complete)
+{
+    // Results are preallocated, so there is no contention between fetches.
+    auto& result = (*results)[index];
+    result.first = ec;
+    result.second = history;
+    complete(error::success);
+}
+
+void blockchain::history_batch_completed(const code& ec,
+    history_results results, const message& request, send_handler handler)
+{
+    auto size = code_size;
+
+    for (const auto& result: *results)
+        size += code_size + sizeof(uint32_t) +
+            history_row_size * result.second.size();
+
+    // [ code:4 ]
+    // [[ code:4 ][ count:4 ][[ row:49 ]...]]...
+    data_chunk payload(size);
+    auto serial = make_unsafe_serializer(payload.begin());
     serial.write_error_code(ec);
 
-    // TODO: add serialization to history_compact.
-    for (const auto& row : history)
+    for (const auto& result: *results)
     {
-        BITCOIN_ASSERT(row.height <= max_uint32);
-        serial.write_byte(static_cast<uint8_t>(row.kind));
-        serial.write_bytes(row.point.to_data());
-        serial.write_4_bytes_little_endian(row.height);
-        serial.write_8_bytes_little_endian(row.value);
+        const auto& history = result.second;
+        BITCOIN_ASSERT(history.size() <= max_uint32);
+        serial.write_error_code(result.first);
+        serial.write_4_bytes_little_endian(
+            static_cast<uint32_t>(history.size()));
+        write_history(serial, history.begin(), history.end());
     }
 
-    handler(message(request, result));
+    handler(message(request, std::move(payload)));
 }
 
 void blockchain::fetch_transaction(server_node& node, const message& request,
@@ -105,23 +324,29 @@ void blockchain::fetch_transaction(server_node& node, const message& request,
 
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     const auto hash = deserial.read_hash();
+    static constexpr auto type = response_cache::kind::transaction;
+
+    if (cached(node, type, hash, request, handler))
+        return;
 
     // The response is restricted to confirmed transactions.
     node.chain().fetch_transaction(hash, true,
         std::bind(&blockchain::transaction_fetched,
-            _1, _2, _3, _4, request, handler));
+            _1, _2, _3, _4, request,
+                cache_handler(node, type, hash, handler)));
 }
 
 void blockchain::transaction_fetched(const code& ec, transaction_ptr tx,
     size_t, size_t, const message& request, send_handler handler)
 {
-    const auto result = build_chunk(
-    {
-        message::to_bytes(ec),
-        tx->to_data(canonical)
-    });
+    // [ code:4 ]
+    // [ tx... ]
+    data_chunk result(code_size + tx->serialized_size(canonical));
+    auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(ec);
+    tx->to_data(canonical, serial);
 
-    handler(message(request, result));
+    handler(message(request, std::move(result)));
 }
 
 void blockchain::fetch_last_height(server_node& node, const message& request,
@@ -135,6 +360,15 @@ void blockchain::fetch_last_height(server_node& node, const message& request,
         return;
     }
 
+    const auto tip = node.tip().get();
+
+    // Answer from the published tip, until it is known use the chain.
+    if (tip)
+    {
+        last_height_fetched(error::success, tip->height, request, handler);
+        return;
+    }
+
     node.chain().fetch_last_height(
         std::bind(&blockchain::last_height_fetched,
             _1, _2, request, handler));
@@ -148,13 +382,13 @@ void blockchain::last_height_fetched(const code& ec, size_t last_height,
 
     // [ code:4 ]
     // [ heigh:4 ]
-    const auto result = build_chunk(
+    auto result = build_chunk(
     {
         message::to_bytes(ec),
         to_little_endian(last_height32)
     });
 
-    handler(message(request, result));
+    handler(message(request, std::move(result)));
 }
 
 void blockchain::fetch_block_header(server_node& node, const message& request,
@@ -178,10 +412,22 @@ void blockchain::fetch_block_header_by_hash(server_node& node,
 
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     const auto block_hash = deserial.read_hash();
+    static constexpr auto type = response_cache::kind::block_header;
+    const auto tip = node.tip().get();
+
+    if (tip && tip->hash == block_hash)
+    {
+        tip_header_fetched(*tip, request, handler);
+        return;
+    }
+
+    if (cached(node, type, block_hash, request, handler))
+        return;
 
     node.chain().fetch_block_header(block_hash,
         std::bind(&blockchain::block_header_fetched,
-            _1, _2, request, handler));
+            _1, _2, request,
+                cache_handler(node, type, block_hash, handler)));
 }
 
 void blockchain::fetch_block_header_by_height(server_node& node,
@@ -192,6 +438,13 @@ void blockchain::fetch_block_header_by_height(server_node& node,
 
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     const uint64_t height = deserial.read_4_bytes_little_endian();
+    const auto tip = node.tip().get();
+
+    if (tip && tip->height == height)
+    {
+        tip_header_fetched(*tip, request, handler);
+        return;
+    }
 
     node.chain().fetch_block_header(height,
         std::bind(&blockchain::block_header_fetched,
@@ -202,14 +455,27 @@ void blockchain::block_header_fetched(const code& ec, header_const_ptr header,
     const message& request, send_handler handler)
 {
     // [ code:4 ]
-    // [ block... ]
-    const auto result = build_chunk(
+    // [ header:80 ]
+    data_chunk result(code_size + header->serialized_size(canonical));
+    auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(ec);
+    header->to_data(canonical, serial);
+
+    handler(message(request, std::move(result)));
+}
+
+void blockchain::tip_header_fetched(const chain_tip::state& tip,
+    const message& request, send_handler handler)
+{
+    // [ code:4 ]
+    // [ header:80 ]
+    auto result = build_chunk(
     {
-        message::to_bytes(ec),
-        header->to_data(canonical)
+        message::to_bytes(error::success),
+        tip.header
     });
 
-    handler(message(request, result));
+    handler(message(request, std::move(result)));
 }
 
 void blockchain::fetch_block_transaction_hashes(server_node& node,
@@ -233,9 +499,16 @@ void blockchain::fetch_block_transaction_hashes_by_hash(server_node& node,
 
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     const auto block_hash = deserial.read_hash();
+    static constexpr auto type =
+        response_cache::kind::block_transaction_hashes;
+
+    if (cached(node, type, block_hash, request, handler))
+        return;
+
     node.chain().fetch_merkle_block(block_hash,
         std::bind(&blockchain::merkle_block_fetched,
-            _1, _2, _3, request, handler));
+            _1, _2, _3, request,
+                cache_handler(node, type, block_hash, handler)));
 }
 
 void blockchain::fetch_block_transaction_hashes_by_height(server_node& node,
@@ -263,7 +536,7 @@ void blockchain::merkle_block_fetched(const code& ec, merkle_block_ptr block,
     for (const auto& hash: block->hashes())
         serial.write_hash(hash);
 
-    handler(message(request, result));
+    handler(message(request, std::move(result)));
 }
 
 void blockchain::fetch_transaction_index(server_node& node,
@@ -279,11 +552,16 @@ void blockchain::fetch_transaction_index(server_node& node,
 
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     const auto hash = deserial.read_hash();
+    static constexpr auto type = response_cache::kind::transaction_index;
+
+    if (cached(node, type, hash, request, handler))
+        return;
 
     // The response is restricted to confirmed transactions (backward compat).
     node.chain().fetch_transaction_position(hash, true,
         std::bind(&blockchain::transaction_index_fetched,
-            _1, _2, _3, request, handler));
+            _1, _2, _3, request,
+                cache_handler(node, type, hash, handler)));
 }
 
 void blockchain::transaction_index_fetched(const code& ec,
@@ -299,14 +577,14 @@ void blockchain::transaction_index_fetched(const code& ec,
     // [ code:4 ]
     // [ block_height:4 ]
     // [ tx_position:4 ]
-    const auto result = build_chunk(
+    auto result = build_chunk(
     {
         message::to_bytes(ec),
         to_little_endian(block_height32),
         to_little_endian(tx_position32)
     });
 
-    handler(message(request, result));
+    handler(message(request, std::move(result)));
 }
 
 void blockchain::fetch_spend(server_node& node, const message& request,
@@ -334,13 +612,13 @@ void blockchain::spend_fetched(const code& ec, const input_point& inpoint,
     // [ code:4 ]
     // [ hash:32 ]
     // [ index:4 ]
-    const auto result = build_chunk(
+    auto result = build_chunk(
     {
         message::to_bytes(ec),
         inpoint.to_data()
     });
 
-    handler(message(request, result));
+    handler(message(request, std::move(result)));
 }
 
 void blockchain::fetch_block_height(server_node& node,
@@ -369,13 +647,13 @@ void blockchain::block_height_fetched(const code& ec, size_t block_height,
 
     // [ code:4 ]
     // [ height:4 ]
-    const auto result = build_chunk(
+    auto result = build_chunk(
     {
         message::to_bytes(ec),
         to_little_endian(block_height32)
     });
 
-    handler(message(request, result));
+    handler(message(request, std::move(result)));
 }
 
 void blockchain::fetch_stealth2(server_node& node, const message& request,
@@ -433,7 +711,7 @@ void blockchain::stealth_fetched(const code& ec,
         serial.write_hash(row.transaction_hash);
     }
 
-    handler(message(request, result));
+    handler(message(request, std::move(result)));
 }
 
 void blockchain::fetch_stealth_transaction(server_node& node,
@@ -487,7 +765,7 @@ void blockchain::stealth_transaction_fetched(const code& ec,
     for (const auto& row: stealth_results)
         serial.write_hash(row.transaction_hash);
 
-    handler(message(request, result));
+    handler(message(request, std::move(result)));
 }
 
 // Save to blockchain and announce to all connected peers.
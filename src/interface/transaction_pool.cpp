@@ -22,6 +22,7 @@
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <utility>
 #include <bitcoin/server/configuration.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/server_node.hpp>
@@ -31,6 +32,7 @@ namespace server {
 
 using namespace std::placeholders;
 
+static constexpr size_t code_size = sizeof(uint32_t);
 static constexpr auto canonical = bc::message::version::level::canonical;
 
 void transaction_pool::fetch_transaction(server_node& node,
@@ -56,13 +58,14 @@ void transaction_pool::fetch_transaction(server_node& node,
 void transaction_pool::transaction_fetched(const code& ec, transaction_ptr tx,
     size_t, size_t, const message& request, send_handler handler)
 {
-    const auto result = build_chunk(
-    {
-        message::to_bytes(ec),
-        tx->to_data(canonical)
-    });
-
-    handler(message(request, result));
+    // [ code:4 ]
+    // [ tx... ]
+    data_chunk result(code_size + tx->serialized_size(canonical));
+    auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(ec);
+    tx->to_data(canonical, serial);
+
+    handler(message(request, std::move(result)));
 }
 
 // Save to tx pool and announce to all connected peers.
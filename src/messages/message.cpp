@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/messages/route.hpp>
 
@@ -69,6 +70,12 @@ message::message(const message& request, const data_chunk& data)
 {
 }
 
+// Construct a response for the request (response data with code, moved).
+message::message(const message& request, data_chunk&& data)
+  : message(request.route(), request.command(), request.id(), std::move(data))
+{
+}
+
 // Construct a response for the route (subscription code only).
 message::message(const server::route& route, const std::string& command,
     uint32_t id, const code& ec)
@@ -83,6 +90,13 @@ message::message(const server::route& route, const std::string& command,
 {
 }
 
+// Construct a response for the route (subscription data with code, moved).
+message::message(const server::route& route, const std::string& command,
+    uint32_t id, data_chunk&& data)
+  : route_(route), command_(command), id_(id), data_(std::move(data))
+{
+}
+
 // Properties.
 //-------------------------------------------------------------------------
 
@@ -129,8 +143,9 @@ code message::receive(zmq::socket& socket)
 
     // Client is undelimited DEALER -> 2 addresses with no delimiter.
     // Client is REQ or delimited DEALER -> 2 addresses with delimiter.
-    route_.address1 = message.dequeue_data();
-    route_.address2 = message.dequeue_data();
+    // Frames are dequeued directly into members to avoid temporaries.
+    if (!message.dequeue(route_.address1) || !message.dequeue(route_.address2))
+        return error::bad_stream;
 
     // In the reply we echo the delimited-ness of the original request.
     route_.delimited = message.size() == 4;
@@ -142,14 +157,16 @@ code message::receive(zmq::socket& socket)
     //-------------------------------------------------------------------------
 
     // Query command (returned to caller).
-    command_ = message.dequeue_text();
+    if (!message.dequeue(command_))
+        return error::bad_stream;
 
     // Arbitrary caller data (returned to caller for correlation).
     if (!message.dequeue(id_))
         return error::bad_stream;
 
     // Serialized query.
-    data_ = message.dequeue_data();
+    if (!message.dequeue(data_))
+        return error::bad_stream;
 
     return error::success;
 }
@@ -174,7 +191,9 @@ code message::send(zmq::socket& socket)
     //-------------------------------------------------------------------------
     message.enqueue(command_);
     message.enqueue_little_endian(id_);
-    message.enqueue(data_);
+
+    // Each message is sent once, so the payload is moved to its frame.
+    message.enqueue(std::move(data_));
 
     return socket.send(message);
 }
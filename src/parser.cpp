@@ -464,6 +464,36 @@ options_metadata parser::load_settings()
         value<uint16_t>(&configured.server.query_workers),
         "The number of query worker threads per endpoint, defaults to 1 (0 disables service)."
     )
+    (
+        "server.heavy_query_workers",
+        value<uint16_t>(&configured.server.heavy_query_workers),
+        "The number of history scan and validation query worker threads per endpoint, defaults to 0 (shares query workers)."
+    )
+    (
+        "server.heavy_query_limit",
+        value<uint16_t>(&configured.server.heavy_query_limit),
+        "The maximum history scan and validation queries in progress per endpoint, beyond which they are answered busy, defaults to 4 (requires heavy query workers)."
+    )
+    (
+        "server.query_rate_limit",
+        value<uint32_t>(&configured.server.query_rate_limit),
+        "The sustained queries per second allowed each client, defaults to 0 (unlimited)."
+    )
+    (
+        "server.query_rate_burst",
+        value<uint32_t>(&configured.server.query_rate_burst),
+        "The queries allowed each client in a burst, defaults to 100."
+    )
+    (
+        "server.response_cache_megabytes",
+        value<uint32_t>(&configured.server.response_cache_megabytes),
+        "The size of the immutable query response cache, defaults to 64 (0 disables)."
+    )
+    (
+        "server.publish_queue_limit",
+        value<uint32_t>(&configured.server.publish_queue_limit),
+        "The maximum blocks or transactions awaiting each publisher, defaults to 10000 (0 for unlimited)."
+    )
     (
         "server.subscription_limit",
         value<uint32_t>(&configured.server.subscription_limit),
@@ -472,7 +502,7 @@ options_metadata parser::load_settings()
     (
         "server.subscription_expiration_minutes",
         value<uint32_t>(&configured.server.subscription_expiration_minutes),
-        "The subscription expiration time, defaults to 10."
+        "The subscription expiration time, which limits any requested by the client, defaults to 10."
     )
     (
         "server.heartbeat_interval_seconds",
@@ -484,11 +514,36 @@ options_metadata parser::load_settings()
         value<bool>(&configured.server.block_service_enabled),
         "Enable the block publishing service, defaults to true."
     )
+    (
+        "server.block_encoding_topics",
+        value<bool>(&configured.server.block_encoding_topics),
+        "Publish each block as header, transaction hashes and full block, each with a topic frame, defaults to false."
+    )
     (
         "server.transaction_service_enabled",
         value<bool>(&configured.server.transaction_service_enabled),
         "Enable the transaction publishing service, defaults to true."
     )
+    (
+        "server.transaction_address_topics",
+        value<bool>(&configured.server.transaction_address_topics),
+        "Publish each transaction once per address hash or stealth prefix, as a topic frame, defaults to false."
+    )
+    (
+        "server.transaction_batch_limit",
+        value<uint32_t>(&configured.server.transaction_batch_limit),
+        "The maximum transactions in each message of the batched transaction endpoint, defaults to 0 (disabled)."
+    )
+    (
+        "server.transaction_batch_microseconds",
+        value<uint32_t>(&configured.server.transaction_batch_microseconds),
+        "The maximum time a transaction awaits its batch, defaults to 1000."
+    )
+    (
+        "server.statistics_service_enabled",
+        value<bool>(&configured.server.statistics_service_enabled),
+        "Enable the query statistics service, defaults to false."
+    )
     (
         "server.public_query_endpoint",
         value<endpoint>(&configured.server.public_query_endpoint),
@@ -509,6 +564,11 @@ options_metadata parser::load_settings()
         value<endpoint>(&configured.server.public_transaction_endpoint),
         "The public transaction publishing endpoint, defaults to 'tcp://*:9094'."
     )
+    (
+        "server.public_transaction_batch_endpoint",
+        value<endpoint>(&configured.server.public_transaction_batch_endpoint),
+        "The public batched transaction publishing endpoint, defaults to 'tcp://*:9095'."
+    )
     (
         "server.secure_query_endpoint",
         value<endpoint>(&configured.server.secure_query_endpoint),
@@ -529,6 +589,16 @@ options_metadata parser::load_settings()
         value<endpoint>(&configured.server.secure_transaction_endpoint),
         "The secure transaction publishing endpoint, defaults to 'tcp://*:9084'."
     )
+    (
+        "server.secure_transaction_batch_endpoint",
+        value<endpoint>(&configured.server.secure_transaction_batch_endpoint),
+        "The secure batched transaction publishing endpoint, defaults to 'tcp://*:9085'."
+    )
+    (
+        "server.statistics_endpoint",
+        value<endpoint>(&configured.server.statistics_endpoint),
+        "The unsecured query statistics endpoint, defaults to 'tcp://127.0.0.1:9090'."
+    )
     (
         "server.server_private_key",
         value<config::sodium>(&configured.server.server_private_key),
@@ -18,12 +18,16 @@
  */
 #include <bitcoin/server/server_node.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <ostream>
 #include <bitcoin/node.hpp>
 #include <bitcoin/server/configuration.hpp>
 #include <bitcoin/server/messages/route.hpp>
+#include <bitcoin/server/utility/block_event.hpp>
+#include <bitcoin/server/utility/transaction_event.hpp>
 #include <bitcoin/server/workers/query_worker.hpp>
 
 namespace libbitcoin {
@@ -38,6 +42,9 @@ server_node::server_node(const configuration& configuration)
   : full_node(configuration),
     configuration_(configuration),
     authenticator_(*this),
+    cache_(configuration.server.response_cache_size()),
+    secure_statistics_("secure"),
+    public_statistics_("public"),
     secure_query_service_(authenticator_, *this, true),
     public_query_service_(authenticator_, *this, false),
     secure_heartbeat_service_(authenticator_, *this, true),
@@ -46,6 +53,7 @@ server_node::server_node(const configuration& configuration)
     public_block_service_(authenticator_, *this, false),
     secure_transaction_service_(authenticator_, *this, true),
     public_transaction_service_(authenticator_, *this, false),
+    statistics_service_(authenticator_, *this),
     secure_notification_worker_(authenticator_, *this, true),
     public_notification_worker_(authenticator_, *this, false)
 {
@@ -65,6 +73,38 @@ const settings& server_node::server_settings() const
     return configuration_.server;
 }
 
+const chain_tip& server_node::tip() const
+{
+    return tip_;
+}
+
+response_cache& server_node::cache()
+{
+    return cache_;
+}
+
+query_statistics& server_node::statistics(bool secure)
+{
+    return secure ? secure_statistics_ : public_statistics_;
+}
+
+query_coalescer& server_node::coalescer()
+{
+    return coalescer_;
+}
+
+void server_node::report(std::ostream& output)
+{
+    secure_statistics_.report(output);
+    public_statistics_.report(output);
+    secure_block_service_.queue().report(output);
+    public_block_service_.queue().report(output);
+    secure_transaction_service_.queue().report(output);
+    public_transaction_service_.queue().report(output);
+    secure_transaction_service_.batch_queue().report(output);
+    public_transaction_service_.batch_queue().report(output);
+}
+
 // Run sequence.
 // ----------------------------------------------------------------------------
 
@@ -119,15 +159,127 @@ bool server_node::close()
 // Notification.
 // ----------------------------------------------------------------------------
 
+// Publish the new tip, remove responses derived from popped blocks, and pass
+// each new block to the publishers and notifiers as one shared event.
+bool server_node::handle_reorganization(const code& ec, size_t fork_height,
+    block_const_ptr_list_const_ptr new_blocks,
+    block_const_ptr_list_const_ptr old_blocks)
+{
+    if (stopped() || ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling reorganization: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    // Invalidate cached responses before publishing the new tip.
+    if (old_blocks && !old_blocks->empty())
+        cache_.invalidate(*old_blocks);
+
+    if (!new_blocks || new_blocks->empty())
+        return true;
+
+    tip_.set(fork_height + new_blocks->size(), new_blocks->back()->header());
+
+    // Blockchain height is size_t but obelisk protocol is 32 bit.
+    auto height = safe_unsigned<uint32_t>(fork_height);
+    block_event::list events;
+    events.reserve(new_blocks->size());
+
+    // The first new block is at the height above the fork point.
+    for (const auto block: *new_blocks)
+        events.push_back(std::make_shared<const block_event>(
+            safe_increment(height), block));
+
+    // Each derivation of a block is computed once, upon first use.
+    secure_block_service_.publish(events);
+    public_block_service_.publish(events);
+    secure_notification_worker_.notify_blocks(events);
+    public_notification_worker_.notify_blocks(events);
+    return true;
+}
+
+// Pass each pool transaction to the publishers and notifiers as one event.
+bool server_node::handle_transaction_pool(const code& ec,
+    transaction_const_ptr tx)
+{
+    if (stopped() || ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new transaction: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    // The transaction is serialized once, upon first use.
+    const transaction_event event(tx);
+    secure_transaction_service_.publish(event);
+    public_transaction_service_.publish(event);
+    secure_notification_worker_.notify_transaction(event);
+    public_notification_worker_.notify_transaction(event);
+    return true;
+}
+
+// The tip is obtained from the chain once, then maintained by reorganization.
+void server_node::start_chain_tip()
+{
+    chain().fetch_last_height(
+        std::bind(&server_node::handle_last_height,
+            this, _1, _2));
+}
+
+void server_node::handle_last_height(const code& ec, size_t height)
+{
+    if (stopped() || ec == error::service_stopped)
+        return;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure fetching chain tip height: " << ec.message();
+        return;
+    }
+
+    chain().fetch_block_header(height,
+        std::bind(&server_node::handle_tip_header,
+            this, _1, _2, height));
+}
+
+void server_node::handle_tip_header(const code& ec, header_const_ptr header,
+    size_t height)
+{
+    if (stopped() || ec == error::service_stopped)
+        return;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure fetching chain tip header: " << ec.message();
+        return;
+    }
+
+    tip_.initialize(height, *header);
+}
+
 // Subscribe (or unsubscribe) to address/stealth prefix notifications.
 code server_node::subscribe_address(const route& reply_to, uint32_t id,
-    const binary& prefix_filter, bool unsubscribe)
+    const binary& prefix_filter, uint32_t ttl_seconds,
+    notification_worker::mode delivery, bool unsubscribe)
 {
     return reply_to.secure ?
         secure_notification_worker_.subscribe_address(reply_to, id,
-            prefix_filter, unsubscribe) :
+            prefix_filter, ttl_seconds, delivery, unsubscribe) :
         public_notification_worker_.subscribe_address(reply_to, id,
-            prefix_filter, unsubscribe);
+            prefix_filter, ttl_seconds, delivery, unsubscribe);
 }
 
 ////// Subscribe to transaction penetration notifications.
@@ -147,10 +299,21 @@ code server_node::subscribe_address(const route& reply_to, uint32_t id,
 
 bool server_node::start_services()
 {
+    // Subscribe to reorganizations to maintain the tip and cached responses,
+    // and to publish and notify blocks. Services not started ignore blocks.
+    subscribe_blockchain(
+        std::bind(&server_node::handle_reorganization,
+            this, _1, _2, _3, _4));
+
+    // Subscribe to pool acceptances to publish and notify transactions.
+    subscribe_transaction(
+        std::bind(&server_node::handle_transaction_pool,
+            this, _1, _2));
+
     return
         start_authenticator() && start_query_services() &&
         start_heartbeat_services() && start_block_services() &&
-        start_transaction_services();
+        start_transaction_services() && start_statistics_service();
 }
 
 bool server_node::start_authenticator()
@@ -158,11 +321,13 @@ bool server_node::start_authenticator()
     const auto& settings = configuration_.server;
 
     // Subscriptions require the query service.
-    if ((!settings.server_private_key && settings.secure_only) ||
+    // The statistics service is not secured, so it is not secure_only.
+    if (((!settings.server_private_key && settings.secure_only) ||
         ((settings.query_workers == 0) &&
         (settings.heartbeat_interval_seconds == 0) &&
         (!settings.block_service_enabled) &&
-        (!settings.transaction_service_enabled)))
+        (!settings.transaction_service_enabled))) &&
+        (!settings.statistics_service_enabled))
         return true;
 
     return authenticator_.start();
@@ -176,6 +341,9 @@ bool server_node::start_query_services()
     if (settings.query_workers == 0)
         return true;
 
+    // Subscribed before fetching the tip so that no update can be missed.
+    start_chain_tip();
+
     // Start secure service, query workers and notification workers if enabled.
     if (settings.server_private_key &&
         (!secure_query_service_.start() || !start_query_workers(true) ||
@@ -245,6 +413,16 @@ bool server_node::start_transaction_services()
     return true;
 }
 
+bool server_node::start_statistics_service()
+{
+    const auto& settings = configuration_.server;
+
+    if (!settings.statistics_service_enabled)
+        return true;
+
+    return statistics_service_.start();
+}
+
 // Called from start_query_services.
 bool server_node::start_query_workers(bool secure)
 {
@@ -263,6 +441,19 @@ bool server_node::start_query_workers(bool secure)
         subscribe_stop([=](const code&) { worker->stop(); });
     }
 
+    // Heavy queries are routed to these workers only if there are any.
+    for (auto count = 0; count < settings.heavy_query_workers; ++count)
+    {
+        const auto worker = std::make_shared<query_worker>(authenticator_,
+            server, secure, true);
+
+        if (!worker->start())
+            return false;
+
+        // Workers register with stop handler just to keep them in scope.
+        subscribe_stop([=](const code&) { worker->stop(); });
+    }
+
     return true;
 }
 
@@ -21,6 +21,8 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
+#include <utility>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/configuration.hpp>
 #include <bitcoin/server/define.hpp>
@@ -35,8 +37,14 @@ using namespace bc::chain;
 using namespace bc::protocol;
 
 static const auto domain = "block";
-const config::endpoint block_service::public_worker("inproc://public_block");
-const config::endpoint block_service::secure_worker("inproc://secure_block");
+
+// The block publication height has always been one below the chain height of
+// the block (the first new block is published at the fork point height). This
+// is preserved for compatibility with existing subscribers.
+static uint32_t publication_height(const block_event& event)
+{
+    return event.height() - 1u;
+}
 
 block_service::block_service(zmq::authenticator& authenticator,
     server_node& node, bool secure)
@@ -44,61 +52,61 @@ block_service::block_service(zmq::authenticator& authenticator,
     secure_(secure),
     verbose_(node.network_settings().verbose),
     settings_(node.server_settings()),
+    queue_(secure ? "secure" : "public", domain,
+        node.server_settings().publish_queue_limit),
     authenticator_(authenticator),
-    node_(node)
+    wakeup_(authenticator)
 {
 }
 
-// There is no unsubscribe so this class shouldn't be restarted.
-bool block_service::start()
+const publish_queue& block_service::queue() const
 {
-    // Subscribe to blockchain reorganizations.
-    node_.subscribe_blockchain(
-        std::bind(&block_service::handle_reorganization,
-            this, _1, _2, _3, _4));
-
-    return zmq::worker::start();
+    return queue_;
 }
 
-// No unsubscribe so must be kept in scope until subscriber stop complete.
-bool block_service::stop()
-{
-    return zmq::worker::stop();
-}
-
-// Implement worker as extended pub-sub.
+// Implement worker as a publisher of queued blocks.
 // The publisher drops messages for lost peers (clients) and high water.
 void block_service::work()
 {
-    zmq::socket xpub(authenticator_, zmq::socket::role::extended_publisher);
-    zmq::socket xsub(authenticator_, zmq::socket::role::extended_subscriber);
+    zmq::socket publisher(authenticator_, zmq::socket::role::publisher);
+    zmq::socket signal(authenticator_, zmq::socket::role::pair);
 
-    // Bind sockets to the service and worker endpoints.
-    if (!started(bind(xpub, xsub)))
+    // Bind socket to the service endpoint.
+    if (!started(bind(publisher) && wakeup_.start(signal)))
         return;
 
-    // TODO: tap in to failure conditions, such as high water.
-    // Relay messages between subscriber and publisher (blocks on context).
-    relay(xpub, xsub);
+    zmq::poller poller;
+    poller.add(publisher);
+    poller.add(signal);
+
+    // We do not receive on the publisher, we use its context stop.
+    // Queued blocks are signaled, so the thread blocks while none are queued.
+    while (!poller.terminated() && !stopped())
+    {
+        if (poller.wait().contains(signal.id()))
+            wakeup_.clear(signal);
+
+        publish(publisher);
+    }
 
     // Unbind the sockets and exit this thread.
-    finished(unbind(xpub, xsub));
+    const auto signal_stop = wakeup_.stop(signal);
+    finished(unbind(publisher) && signal_stop);
 }
 
 // Bind/Unbind.
 //-----------------------------------------------------------------------------
 
-bool block_service::bind(zmq::socket& xpub, zmq::socket& xsub)
+bool block_service::bind(zmq::socket& publisher)
 {
     const auto security = secure_ ? "secure" : "public";
-    const auto& worker = secure_ ? secure_worker : public_worker;
     const auto& service = secure_ ? settings_.secure_block_endpoint :
         settings_.public_block_endpoint;
 
-    if (!authenticator_.apply(xpub, domain, secure_))
+    if (!authenticator_.apply(publisher, domain, secure_))
         return false;
 
-    auto ec = xpub.bind(service);
+    const auto ec = publisher.bind(service);
 
     if (ec)
     {
@@ -108,95 +116,58 @@ bool block_service::bind(zmq::socket& xpub, zmq::socket& xsub)
         return false;
     }
 
-    ec = xsub.bind(worker);
-
-    if (ec)
-    {
-        LOG_ERROR(LOG_SERVER)
-            << "Failed to bind " << security << " block workers to "
-            << worker << " : " << ec.message();
-        return false;
-    }
-
     LOG_INFO(LOG_SERVER)
         << "Bound " << security << " block service to " << service;
     return true;
 }
 
-bool block_service::unbind(zmq::socket& xpub, zmq::socket& xsub)
+bool block_service::unbind(zmq::socket& publisher)
 {
-    // Stop both even if one fails.
-    const auto service_stop = xpub.stop();
-    const auto worker_stop = xsub.stop();
     const auto security = secure_ ? "secure" : "public";
 
-    if (!service_stop)
-        LOG_ERROR(LOG_SERVER)
-            << "Failed to unbind " << security << " block service.";
-
-    if (!worker_stop)
-        LOG_ERROR(LOG_SERVER)
-            << "Failed to unbind " << security << " block workers.";
-
     // Don't log stop success.
-    return service_stop && worker_stop;
+    if (publisher.stop())
+        return true;
+
+    LOG_ERROR(LOG_SERVER)
+        << "Failed to unbind " << security << " block service.";
+    return false;
 }
 
 // Publish (integral worker).
 // ----------------------------------------------------------------------------
 
-bool block_service::handle_reorganization(const code& ec, size_t fork_height,
-    block_const_ptr_list_const_ptr new_blocks, block_const_ptr_list_const_ptr)
+// Reorganizations are off the pub-sub thread, so blocks are queued to it.
+void block_service::publish(const block_event::list& events)
 {
-    if (stopped() || ec == error::service_stopped)
-        return false;
-
-    if (ec)
-    {
-        LOG_WARNING(LOG_SERVER)
-            << "Failure handling new block: " << ec.message();
+    if (stopped())
+        return;
 
-        // Don't let a failure here prevent prevent future notifications.
-        return true;
-    }
+    for (const auto& event: events)
+        enqueue_block(*event);
 
-    // Blockchain height is 64 bit but obelisk protocol is 32 bit.
-    publish_blocks(safe_unsigned<uint32_t>(fork_height), new_blocks);
-    return true;
+    wakeup_.notify();
 }
 
-void block_service::publish_blocks(uint32_t fork_height,
-    block_const_ptr_list_const_ptr blocks)
+void block_service::enqueue_block(const block_event& event)
 {
-    if (stopped())
-        return;
-
     const auto security = secure_ ? "secure" : "public";
-    const auto& endpoint = secure_ ? block_service::secure_worker :
-        block_service::public_worker;
+    const auto queued = settings_.block_encoding_topics ?
+        enqueue_topics(event) : enqueue(event);
 
-    // Subscriptions are off the pub-sub thread so this must connect back.
-    // This could be optimized by caching the socket as thread static.
-    zmq::socket publisher(authenticator_, zmq::socket::role::publisher);
-    const auto ec = publisher.connect(endpoint);
-
-    if (ec == error::service_stopped)
-        return;
-
-    if (ec)
+    if (!queued)
     {
         LOG_WARNING(LOG_SERVER)
-            << "Failed to connect " << security << " block worker: "
-            << ec.message();
+            << "Dropped " << security << " block ["
+            << encode_hash(event.hash()) << "] at queue limit.";
         return;
     }
 
-    BITCOIN_ASSERT(blocks->size() <= max_uint32);
-    BITCOIN_ASSERT(fork_height < max_uint32 - blocks->size());
-    auto height = fork_height;
-
-    for (const auto block: *blocks)
-        publish_block(publisher, height++, block);
+    // This isn't actually a request, should probably update settings.
+    if (verbose_)
+        LOG_DEBUG(LOG_SERVER)
+            << "Queued " << security << " block ["
+            << encode_hash(event.hash()) << "]";
 }
 
 // [ height:4 ]
@@ -204,35 +175,70 @@ void block_service::publish_blocks(uint32_t fork_height,
 // [ txs... ]
 // The payload for block publication is delimited within the zeromq message.
 // This is required for compatability and inconsistent with query payloads.
-void block_service::publish_block(zmq::socket& publisher, uint32_t height,
-    block_const_ptr block)
+bool block_service::enqueue(const block_event& event)
 {
-    if (stopped())
-        return;
+    // The block is serialized once for all publishers.
+    zmq::message broadcast;
+    broadcast.enqueue_little_endian(publication_height(event));
+    broadcast.enqueue(event.data());
+    return queue_.push(std::move(broadcast));
+}
 
-    const auto security = secure_ ? "secure" : "public";
+// header: [ topic ] [ height:4 ] [ header:80 ]
+// txids:  [ topic ] [ height:4 ] [ header:80 ] [ tx_hash:32... ]
+// block:  [ topic ] [ height:4 ] [ header:80 txs... ]
+// Each encoding is a distinct topic, none a prefix of another, so that
+// subscribers select one by zeromq subscription. Each encoding is produced
+// once per block, shared by all publishers.
+bool block_service::enqueue_topics(const block_event& event)
+{
+    static const std::string topic_header("header");
+    static const std::string topic_hashes("txids");
+    static const std::string topic_block("block");
+
+    const auto header = event.header_data();
+
+    zmq::message headers;
+    headers.enqueue(topic_header);
+    headers.enqueue_little_endian(publication_height(event));
+    headers.enqueue(data_chunk{ header.begin(), header.end() });
+
+    zmq::message hashes;
+    hashes.enqueue(topic_hashes);
+    hashes.enqueue_little_endian(publication_height(event));
+    hashes.enqueue(data_chunk{ header.begin(), header.end() });
+    hashes.enqueue(event.transaction_hashes());
+
+    zmq::message block;
+    block.enqueue(topic_block);
+    block.enqueue_little_endian(publication_height(event));
+    block.enqueue(event.data());
+
+    // Smaller encodings are queued first, so are not dropped for larger.
+    auto queued = queue_.push(std::move(headers));
+    queued &= queue_.push(std::move(hashes));
+    queued &= queue_.push(std::move(block));
+    return queued;
+}
 
+// Send all queued blocks on the bound publisher.
+void block_service::publish(zmq::socket& publisher)
+{
+    const auto security = secure_ ? "secure" : "public";
     zmq::message broadcast;
-    broadcast.enqueue_little_endian(height);
-    broadcast.enqueue(block->to_data(bc::message::version::level::canonical));
-    const auto ec = publisher.send(broadcast);
-
-    if (ec == error::service_stopped)
-        return;
 
-    if (ec)
+    while (!stopped() && queue_.pop(broadcast))
     {
-        LOG_WARNING(LOG_SERVER)
-            << "Failed to publish " << security << " bloc ["
-            << encode_hash(block->header().hash()) << "] " << ec.message();
-        return;
-    }
+        const auto ec = publisher.send(broadcast);
 
-    // This isn't actually a request, should probably update settings.
-    if (verbose_)
-        LOG_DEBUG(LOG_SERVER)
-            << "Published " << security << " block ["
-            << encode_hash(block->header().hash()) << "]";
+        if (ec == error::service_stopped)
+            return;
+
+        if (ec)
+            LOG_WARNING(LOG_SERVER)
+                << "Failed to publish " << security << " block: "
+                << ec.message();
+    }
 }
 
 } // namespace server
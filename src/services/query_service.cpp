@@ -18,7 +18,14 @@
  */
 #include <bitcoin/server/services/query_service.hpp>
 
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <utility>
 #include <bitcoin/protocol.hpp>
+#include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/server_node.hpp>
 #include <bitcoin/server/settings.hpp>
 
@@ -31,6 +38,10 @@ using namespace bc::protocol;
 static const auto domain = "query";
 const config::endpoint query_service::public_query("inproc://public_query");
 const config::endpoint query_service::secure_query("inproc://secure_query");
+const config::endpoint query_service::public_heavy_query(
+    "inproc://public_heavy_query");
+const config::endpoint query_service::secure_heavy_query(
+    "inproc://secure_heavy_query");
 const config::endpoint query_service::public_notify("inproc://public_notify");
 const config::endpoint query_service::secure_notify("inproc://secure_notify");
 
@@ -38,7 +49,11 @@ query_service::query_service(zmq::authenticator& authenticator,
     server_node& node, bool secure)
   : worker(priority(node.server_settings().priority)),
     secure_(secure),
+    lanes_(node.server_settings().heavy_query_workers > 0),
+    heavy_limit_(node.server_settings().heavy_query_limit),
     settings_(node.server_settings()),
+    limiter_(settings_.query_rate_limit, settings_.query_rate_burst),
+    heavy_pending_(0),
     authenticator_(authenticator)
 {
 }
@@ -50,15 +65,17 @@ void query_service::work()
 {
     zmq::socket router(authenticator_, zmq::socket::role::router);
     zmq::socket query_dealer(authenticator_, zmq::socket::role::dealer);
+    zmq::socket heavy_dealer(authenticator_, zmq::socket::role::dealer);
     zmq::socket notify_dealer(authenticator_, zmq::socket::role::dealer);
 
     // Bind sockets to the service and worker endpoints.
-    if (!started(bind(router, query_dealer, notify_dealer)))
+    if (!started(bind(router, query_dealer, heavy_dealer, notify_dealer)))
         return;
 
     zmq::poller poller;
     poller.add(router);
     poller.add(query_dealer);
+    poller.add(heavy_dealer);
     poller.add(notify_dealer);
 
     while (!poller.terminated() && !stopped())
@@ -67,7 +84,7 @@ void query_service::work()
 
         if (signaled.contains(router.id()))
         {
-            if (!forward(router, query_dealer))
+            if (!admit(router, query_dealer, heavy_dealer))
             {
                 LOG_WARNING(LOG_SERVER)
                     << "Failed to forward from router to query_dealer.";
@@ -83,6 +100,19 @@ void query_service::work()
             }
         }
 
+        if (signaled.contains(heavy_dealer.id()))
+        {
+            // Each heavy query has exactly one response.
+            if (heavy_pending_ > 0)
+                --heavy_pending_;
+
+            if (!forward(heavy_dealer, router))
+            {
+                LOG_WARNING(LOG_SERVER)
+                    << "Failed to forward from heavy_dealer to router.";
+            }
+        }
+
         if (signaled.contains(notify_dealer.id()))
         {
             if (!forward(notify_dealer, router))
@@ -94,17 +124,116 @@ void query_service::work()
     }
 
     // Unbind the sockets and exit this thread.
-    finished(unbind(router, query_dealer, notify_dealer));
+    finished(unbind(router, query_dealer, heavy_dealer, notify_dealer));
+}
+
+// Admission.
+//-----------------------------------------------------------------------------
+
+// Commands that may scan large indexes or validate, and so may be slow.
+bool query_service::heavy(const std::string& command) const
+{
+    static const std::unordered_set<std::string> commands
+    {
+        "blockchain.fetch_history2",
+        "blockchain.fetch_history3",
+        "blockchain.fetch_history4",
+        "blockchain.fetch_stealth2",
+        "blockchain.broadcast",
+        "blockchain.validate",
+        "transaction_pool.broadcast",
+        "transaction_pool.validate2"
+    };
+
+    return commands.find(command) != commands.end();
+}
+
+// Clients are limited by route identity. The CURVE public key of the client
+// is not exposed by the message, so secure clients are limited in the same
+// manner. The identity is assigned per connection unless set by the client,
+// so a client may renew its allowance by reconnecting. This is bounded by the
+// limit on buckets, beyond which new identities share one allowance.
+// Over-limit queries are answered with a busy code, in place of the query
+// payload, without reaching the workers. Heavy queries are forwarded to their
+// own workers, and are answered busy when the limit of heavy queries in
+// progress is reached, so that they cannot occupy all chain threads.
+bool query_service::admit(zmq::socket& router, zmq::socket& query_dealer,
+    zmq::socket& heavy_dealer)
+{
+    if (!lanes_ && limiter_.disabled())
+        return forward(router, query_dealer);
+
+    // [ identity ]
+    // [ delimiter ] (optional)
+    // [ command ]
+    // [ id ]
+    // [ payload ]
+    // Frames are relayed as received, only the identity and command are read.
+    std::vector<zmq::frame::ptr> frames;
+
+    do
+    {
+        frames.push_back(std::make_shared<zmq::frame>());
+        const auto ec = frames.back()->receive(router);
+
+        if (ec)
+            return false;
+
+    } while (frames.back()->more());
+
+    // Malformed queries are forwarded, for the worker to drop or reply.
+    const auto valid = frames.size() >= 4 && frames.size() <= 5;
+    auto admitted = !valid || limiter_.disabled() ||
+        limiter_.admit(frames.front()->payload());
+
+    if (!admitted)
+        LOG_DEBUG(LOG_SERVER)
+            << "Rate limited query from ["
+            << encode_base16(frames.front()->payload()) << "]";
+
+    // The command frame precedes the id and payload frames.
+    auto heavy_lane = false;
+
+    if (admitted && valid && lanes_)
+    {
+        const auto command = frames[frames.size() - 3]->payload();
+        heavy_lane = heavy(std::string(command.begin(), command.end()));
+        admitted = !heavy_lane || heavy_pending_ < heavy_limit_;
+    }
+
+    // The busy code replaces the payload frame.
+    if (!admitted)
+        frames.back() = std::make_shared<zmq::frame>(
+            message::to_bytes(error::oversubscribed));
+
+    auto& target = admitted ? (heavy_lane ? heavy_dealer : query_dealer) :
+        router;
+
+    for (size_t index = 0; index < frames.size(); ++index)
+    {
+        const auto last = index + 1 == frames.size();
+        const auto ec = frames[index]->send(target, last);
+
+        if (ec)
+            return false;
+    }
+
+    if (admitted && heavy_lane)
+        ++heavy_pending_;
+
+    return true;
 }
 
 // Bind/Unbind.
 //-----------------------------------------------------------------------------
 
 bool query_service::bind(zmq::socket& router, zmq::socket& query_dealer,
-    zmq::socket& notify_dealer)
+    zmq::socket& heavy_dealer, zmq::socket& notify_dealer)
 {
     const auto security = secure_ ? "secure" : "public";
     const auto& query_worker = secure_ ? secure_query : public_query;
+    const auto& heavy_worker = secure_ ? secure_heavy_query :
+        public_heavy_query;
     const auto& notify_worker = secure_ ? secure_notify : public_notify;
     const auto& query_service = secure_ ? settings_.secure_query_endpoint :
         settings_.public_query_endpoint;
@@ -132,6 +261,16 @@ bool query_service::bind(zmq::socket& router, zmq::socket& query_dealer,
         return false;
     }
 
+    ec = heavy_dealer.bind(heavy_worker);
+
+    if (ec)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to bind " << security << " heavy query workers to "
+            << heavy_worker << " : " << ec.message();
+        return false;
+    }
+
     ec = notify_dealer.bind(notify_worker);
 
     if (ec)
@@ -148,11 +287,12 @@ bool query_service::bind(zmq::socket& router, zmq::socket& query_dealer,
 }
 
 bool query_service::unbind(zmq::socket& router, zmq::socket& query_dealer,
-    zmq::socket& notify_dealer)
+    zmq::socket& heavy_dealer, zmq::socket& notify_dealer)
 {
     // Stop all even if one fails.
     const auto service_stop = router.stop();
     const auto query_stop = query_dealer.stop();
+    const auto heavy_stop = heavy_dealer.stop();
     const auto notify_stop = notify_dealer.stop();
     const auto security = secure_ ? "secure" : "public";
 
@@ -164,12 +304,16 @@ bool query_service::unbind(zmq::socket& router, zmq::socket& query_dealer,
         LOG_ERROR(LOG_SERVER)
             << "Failed to unbind " << security << " query workers.";
 
+    if (!heavy_stop)
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to unbind " << security << " heavy query workers.";
+
     if (!notify_stop)
         LOG_ERROR(LOG_SERVER)
             << "Failed to unbind " << security << " notify workers.";
 
     // Don't log stop success.
-    return service_stop && query_stop && notify_stop;
+    return service_stop && query_stop && heavy_stop && notify_stop;
 }
 
 } // namespace server
@@ -0,0 +1,150 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/services/statistics_service.hpp>
+
+#include <sstream>
+#include <string>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/settings.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+static const auto domain = "statistics";
+
+using namespace bc::protocol;
+
+statistics_service::statistics_service(zmq::authenticator& authenticator,
+    server_node& node)
+  : worker(priority(node.server_settings().priority)),
+    verbose_(node.network_settings().verbose),
+    settings_(node.server_settings()),
+    node_(node),
+    authenticator_(authenticator)
+{
+}
+
+// Implement service as a replier.
+// The replier must respond to each request before it may receive another.
+void statistics_service::work()
+{
+    zmq::socket replier(authenticator_, zmq::socket::role::replier);
+
+    // Bind socket to the service endpoint.
+    if (!started(bind(replier)))
+        return;
+
+    zmq::poller poller;
+    poller.add(replier);
+
+    while (!poller.terminated() && !stopped())
+    {
+        if (poller.wait().contains(replier.id()))
+            reply(replier);
+    }
+
+    // Unbind the socket and exit this thread.
+    finished(unbind(replier));
+}
+
+// Bind/Unbind.
+//-----------------------------------------------------------------------------
+
+// The statistics endpoint is not secured, it should be bound to loopback.
+bool statistics_service::bind(zmq::socket& replier)
+{
+    const auto& endpoint = settings_.statistics_endpoint;
+
+    if (!authenticator_.apply(replier, domain, false))
+        return false;
+
+    const auto ec = replier.bind(endpoint);
+
+    if (ec)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to bind statistics service to " << endpoint << " : "
+            << ec.message();
+        return false;
+    }
+
+    LOG_INFO(LOG_SERVER)
+        << "Bound statistics service to " << endpoint;
+    return true;
+}
+
+bool statistics_service::unbind(zmq::socket& replier)
+{
+    // Don't log stop success.
+    if (replier.stop())
+        return true;
+
+    LOG_ERROR(LOG_SERVER)
+        << "Failed to disconnect statistics service.";
+    return false;
+}
+
+// Reply Execution (integral worker).
+//-----------------------------------------------------------------------------
+
+// The content of the request is ignored.
+void statistics_service::reply(zmq::socket& replier)
+{
+    if (stopped())
+        return;
+
+    zmq::message request;
+    auto ec = replier.receive(request);
+
+    if (ec == error::service_stopped)
+        return;
+
+    if (ec)
+    {
+        LOG_DEBUG(LOG_SERVER)
+            << "Failed to receive statistics request: " << ec.message();
+        return;
+    }
+
+    zmq::message response;
+    response.enqueue(report());
+    ec = replier.send(response);
+
+    if (ec && ec != error::service_stopped)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to send statistics: " << ec.message();
+        return;
+    }
+
+    if (verbose_)
+        LOG_DEBUG(LOG_SERVER)
+            << "Sent statistics report.";
+}
+
+std::string statistics_service::report()
+{
+    std::ostringstream output;
+    node_.report(output);
+    return output.str();
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -18,8 +18,12 @@
  */
 #include <bitcoin/server/services/transaction_service.hpp>
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
+#include <utility>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/configuration.hpp>
 #include <bitcoin/server/server_node.hpp>
@@ -34,184 +38,358 @@ using namespace bc::message;
 using namespace bc::protocol;
 
 static const auto domain = "transaction";
-const config::endpoint transaction_service::public_worker("inproc://public_tx");
-const config::endpoint transaction_service::secure_worker("inproc://secure_tx");
+static const auto batch_domain = "transaction_batch";
 
 transaction_service::transaction_service(zmq::authenticator& authenticator,
     server_node& node, bool secure)
   : worker(priority(node.server_settings().priority)),
     secure_(secure),
     verbose_(node.network_settings().verbose),
+    batch_limit_(node.server_settings().transaction_batch_limit),
+    batch_window_(node.server_settings().transaction_batch_window()),
     settings_(node.server_settings()),
+    queue_(secure ? "secure" : "public", domain,
+        node.server_settings().publish_queue_limit),
+    batch_queue_(secure ? "secure" : "public", batch_domain,
+        node.server_settings().publish_queue_limit),
     authenticator_(authenticator),
-    node_(node)
+    wakeup_(authenticator)
 {
 }
 
-// There is no unsubscribe so this class shouldn't be restarted.
-bool transaction_service::start()
+const publish_queue& transaction_service::queue() const
 {
-    // Subscribe to transaction pool acceptances.
-    node_.subscribe_transaction(
-        std::bind(&transaction_service::handle_transaction,
-            this, _1, _2));
-
-    return zmq::worker::start();
+    return queue_;
 }
 
-// No unsubscribe so must be kept in scope until subscriber stop complete.
-bool transaction_service::stop()
+const publish_queue& transaction_service::batch_queue() const
 {
-    return zmq::worker::stop();
+    return batch_queue_;
 }
 
-// Implement worker as extended pub-sub.
+// Implement worker as a publisher of queued transactions.
 // The publisher drops messages for lost peers (clients) and high water.
+// Batches are published on a distinct endpoint, as existing subscribers to
+// the transaction endpoint cannot distinguish a batch from a transaction.
 void transaction_service::work()
 {
-    zmq::socket xpub(authenticator_, zmq::socket::role::extended_publisher);
-    zmq::socket xsub(authenticator_, zmq::socket::role::extended_subscriber);
+    zmq::socket publisher(authenticator_, zmq::socket::role::publisher);
+    zmq::socket batcher(authenticator_, zmq::socket::role::publisher);
+    zmq::socket signal(authenticator_, zmq::socket::role::pair);
+    const auto batching = batch_limit_ > 0;
 
-    // Bind sockets to the service and worker endpoints.
-    if (!started(bind(xpub, xsub)))
+    // Bind sockets to the service endpoints.
+    if (!started(bind(publisher) && (!batching || bind_batch(batcher)) &&
+        wakeup_.start(signal)))
         return;
 
-    // TODO: tap in to failure conditions, such as high water.
-    // Relay messages between subscriber and publisher (blocks on context).
-    relay(xpub, xsub);
+    zmq::poller poller;
+    poller.add(publisher);
+    poller.add(signal);
+    int32_t timeout = 0;
+
+    // We do not receive on the publishers, we use their context stop.
+    // Queued transactions are signaled, so the thread blocks while none are
+    // queued, and the timer is set only while a batch awaits its window.
+    while (!poller.terminated() && !stopped())
+    {
+        const auto signaled = timeout == 0 ? poller.wait() :
+            poller.wait(timeout);
+
+        if (signaled.contains(signal.id()))
+            wakeup_.clear(signal);
+
+        publish(publisher);
+
+        if (batching)
+        {
+            timeout = expire_batch();
+            publish_batches(batcher);
+        }
+    }
 
     // Unbind the sockets and exit this thread.
-    finished(unbind(xpub, xsub));
+    const auto signal_stop = wakeup_.stop(signal);
+    const auto unbound = unbind(publisher) && signal_stop;
+    finished(unbound && (!batching || unbind_batch(batcher)));
 }
 
 // Bind/Unbind.
 //-----------------------------------------------------------------------------
 
-bool transaction_service::bind(zmq::socket& xpub, zmq::socket& xsub)
+bool transaction_service::bind(zmq::socket& publisher)
 {
-    const auto security = secure_ ? "secure" : "public";
-    const auto& worker = secure_ ? secure_worker : public_worker;
     const auto& service = secure_ ? settings_.secure_transaction_endpoint :
         settings_.public_transaction_endpoint;
 
-    if (!authenticator_.apply(xpub, domain, secure_))
-        return false;
+    return bind(publisher, service, "transaction");
+}
 
-    auto ec = xpub.bind(service);
+bool transaction_service::bind_batch(zmq::socket& publisher)
+{
+    const auto& service = secure_ ?
+        settings_.secure_transaction_batch_endpoint :
+        settings_.public_transaction_batch_endpoint;
 
-    if (ec)
-    {
-        LOG_ERROR(LOG_SERVER)
-            << "Failed to bind " << security << " transaction service to "
-            << service << " : " << ec.message();
+    return bind(publisher, service, "transaction batch");
+}
+
+bool transaction_service::unbind(zmq::socket& publisher)
+{
+    return unbind(publisher, "transaction");
+}
+
+bool transaction_service::unbind_batch(zmq::socket& publisher)
+{
+    return unbind(publisher, "transaction batch");
+}
+
+bool transaction_service::bind(zmq::socket& publisher,
+    const config::endpoint& service, const std::string& feed)
+{
+    const auto security = secure_ ? "secure" : "public";
+
+    if (!authenticator_.apply(publisher, domain, secure_))
         return false;
-    }
 
-    ec = xsub.bind(worker);
+    const auto ec = publisher.bind(service);
 
     if (ec)
     {
         LOG_ERROR(LOG_SERVER)
-            << "Failed to bind " << security << " transaction workers to "
-            << worker << " : " << ec.message();
+            << "Failed to bind " << security << " " << feed
+            << " service to " << service << " : " << ec.message();
         return false;
     }
 
     LOG_INFO(LOG_SERVER)
-        << "Bound " << security << " transaction service to " << service;
+        << "Bound " << security << " " << feed << " service to " << service;
     return true;
 }
 
-bool transaction_service::unbind(zmq::socket& xpub, zmq::socket& xsub)
+bool transaction_service::unbind(zmq::socket& publisher,
+    const std::string& feed)
 {
-    // Stop both even if one fails.
-    const auto service_stop = xpub.stop();
-    const auto worker_stop = xsub.stop();
     const auto security = secure_ ? "secure" : "public";
 
-    if (!service_stop)
-        LOG_ERROR(LOG_SERVER)
-            << "Failed to unbind " << security << " transaction service.";
-
-    if (!worker_stop)
-        LOG_ERROR(LOG_SERVER)
-            << "Failed to unbind " << security << " transaction workers.";
-
     // Don't log stop success.
-    return service_stop && worker_stop;
+    if (publisher.stop())
+        return true;
+
+    LOG_ERROR(LOG_SERVER)
+        << "Failed to unbind " << security << " " << feed << " service.";
+    return false;
 }
 
 // Publish (integral worker).
 // ----------------------------------------------------------------------------
 
-bool transaction_service::handle_transaction(const code& ec,
-    transaction_const_ptr tx)
+// Acceptances are off the pub-sub thread, so transactions are queued to it.
+// The transaction is serialized once for all publishers.
+void transaction_service::publish(const transaction_event& event)
 {
-    if (stopped() || ec == error::service_stopped)
-        return false;
+    if (stopped())
+        return;
 
-    if (ec)
-    {
-        LOG_WARNING(LOG_SERVER)
-            << "Failure handling new transaction: " << ec.message();
+    const auto security = secure_ ? "secure" : "public";
+    const auto queued = settings_.transaction_address_topics ?
+        enqueue_topics(event) : enqueue(event.data());
 
-        // Don't let a failure here prevent prevent future notifications.
-        return true;
+    // The batched feed is independent of the per transaction feed.
+    if (batch_limit_ > 0)
+        enqueue_batch(event.data());
+
+    wakeup_.notify();
+
+    // Drops are counted by the queue, logging each would flood the log.
+    if (!queued)
+    {
+        if (verbose_)
+            LOG_DEBUG(LOG_SERVER)
+                << "Dropped " << security << " transaction ["
+                << encode_hash(event.transaction()->hash())
+                << "] at queue limit.";
+        return;
     }
 
-    publish_transaction(tx);
-    return true;
+    // This isn't actually a request, should probably update settings.
+    if (verbose_)
+        LOG_DEBUG(LOG_SERVER)
+            << "Queued " << security << " transaction ["
+            << encode_hash(event.transaction()->hash()) << "]";
 }
 
 // [ tx... ]
-void transaction_service::publish_transaction(transaction_const_ptr tx)
+bool transaction_service::enqueue(const data_chunk& tx_data)
 {
-    if (stopped())
-        return;
+    zmq::message broadcast;
+    broadcast.enqueue(tx_data);
+    return queue_.push(std::move(broadcast));
+}
 
-    const auto security = secure_ ? "secure" : "public";
-    const auto& endpoint = secure_ ? transaction_service::secure_worker :
-        transaction_service::public_worker;
+// [ topic:0|4|20 ]
+// [ tx... ]
+// Subscribers filter on an address hash or stealth prefix (little endian)
+// using zeromq's native subscription prefix matching, and so receive only
+// the transactions that they would otherwise select locally. A transaction
+// without an address is published once, with an empty topic.
+bool transaction_service::enqueue_topics(const transaction_event& event)
+{
+    static const auto less = [](const block_event::key& left,
+        const block_event::key& right)
+    {
+        const auto first = left.slice();
+        const auto second = right.slice();
+        return std::lexicographical_compare(first.begin(), first.end(),
+            second.begin(), second.end());
+    };
+
+    static const auto equal = [](const block_event::key& left,
+        const block_event::key& right)
+    {
+        return !less(left, right) && !less(right, left);
+    };
 
-    // Subscriptions are off the pub-sub thread so this must connect back.
-    // This could be optimized by caching the socket as thread static.
-    zmq::socket publisher(authenticator_, zmq::socket::role::publisher);
-    auto ec = publisher.connect(endpoint);
+    const auto& tx_data = event.data();
+    auto keys = event.keys();
 
-    if (ec == error::service_stopped)
-        return;
+    // Each topic is published once per transaction.
+    std::sort(keys.begin(), keys.end(), less);
+    keys.erase(std::unique(keys.begin(), keys.end(), equal), keys.end());
 
-    if (ec)
+    if (keys.empty())
     {
-        LOG_WARNING(LOG_SERVER)
-            << "Failed to connect " << security << " transaction worker: "
-            << ec.message();
-        return;
+        zmq::message broadcast;
+        broadcast.enqueue();
+        broadcast.enqueue(tx_data);
+        return queue_.push(std::move(broadcast));
     }
 
-    if (stopped())
-        return;
+    auto queued = true;
 
-    zmq::message broadcast;
-    broadcast.enqueue(tx->to_data(bc::message::version::level::canonical));
-    ec = publisher.send(broadcast);
+    for (const auto& key: keys)
+    {
+        const auto topic = key.slice();
+        zmq::message broadcast;
+        broadcast.enqueue(data_chunk{ topic.begin(), topic.end() });
+        broadcast.enqueue(tx_data);
+        queued &= queue_.push(std::move(broadcast));
+    }
 
-    if (ec == error::service_stopped)
-        return;
+    return queued;
+}
 
-    if (ec)
+// Batch (opt-in).
+// ----------------------------------------------------------------------------
+
+void transaction_service::enqueue_batch(const data_chunk& tx_data)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(batch_mutex_);
+
+    if (batch_.empty())
+        batch_started_ = asio::steady_clock::now();
+
+    batch_.push_back(tx_data);
+
+    if (batch_.size() >= batch_limit_)
+        flush_batch();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Called from the publisher thread, before publishing the batch queue.
+// Returns the milliseconds remaining in the open batch window, zero if none.
+int32_t transaction_service::expire_batch()
+{
+    if (batch_limit_ == 0)
+        return 0;
+
+    const auto now = asio::steady_clock::now();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(batch_mutex_);
+
+    if (batch_.empty())
+        return 0;
+
+    const auto elapsed = now - batch_started_;
+
+    if (elapsed >= batch_window_)
     {
-        LOG_WARNING(LOG_SERVER)
-            << "Failed to publish " << security << " transaction ["
-            << encode_hash(tx->hash()) << "] " << ec.message();
-        return;
+        flush_batch();
+        return 0;
     }
 
-    // This isn't actually a request, should probably update settings.
-    if (verbose_)
+    // Round up so that the window has expired upon the next wake.
+    const auto remaining = std::chrono::duration_cast<asio::milliseconds>(
+        batch_window_ - elapsed) + asio::milliseconds(1);
+
+    return static_cast<int32_t>(remaining.count());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// [ tx... ]...
+// Each batch is one multipart message of one frame per transaction, on the
+// batch endpoint only. The caller must lock.
+void transaction_service::flush_batch()
+{
+    const auto security = secure_ ? "secure" : "public";
+    const auto count = batch_.size();
+
+    zmq::message broadcast;
+
+    for (auto& tx_data: batch_)
+        broadcast.enqueue(std::move(tx_data));
+
+    batch_.clear();
+
+    // Drops are counted by the queue, logging each would flood the log.
+    if (!batch_queue_.push(std::move(broadcast)) && verbose_)
         LOG_DEBUG(LOG_SERVER)
-            << "Published " << security << " transaction ["
-            << encode_hash(tx->hash()) << "]";
+            << "Dropped " << security << " batch of " << count
+            << " transactions at queue limit.";
+}
+
+// Send all queued transactions on the bound publisher.
+void transaction_service::publish(zmq::socket& publisher)
+{
+    const auto security = secure_ ? "secure" : "public";
+    zmq::message broadcast;
+
+    while (!stopped() && queue_.pop(broadcast))
+    {
+        const auto ec = publisher.send(broadcast);
+
+        if (ec == error::service_stopped)
+            return;
+
+        if (ec)
+            LOG_WARNING(LOG_SERVER)
+                << "Failed to publish " << security << " transaction: "
+                << ec.message();
+    }
+}
+
+// Send all queued transaction batches on the bound batch publisher.
+void transaction_service::publish_batches(zmq::socket& publisher)
+{
+    const auto security = secure_ ? "secure" : "public";
+    zmq::message broadcast;
+
+    while (!stopped() && batch_queue_.pop(broadcast))
+    {
+        const auto ec = publisher.send(broadcast);
+
+        if (ec == error::service_stopped)
+            return;
+
+        if (ec)
+            LOG_WARNING(LOG_SERVER)
+                << "Failed to publish " << security << " transaction batch: "
+                << ec.message();
+    }
 }
 
 } // namespace server
@@ -27,21 +27,35 @@ using namespace asio;
 
 settings::settings()
   : query_workers(1),
+    heavy_query_workers(0),
+    heavy_query_limit(4),
+    query_rate_limit(0),
+    query_rate_burst(100),
+    response_cache_megabytes(64),
+    publish_queue_limit(10000),
     heartbeat_interval_seconds(5),
     subscription_expiration_minutes(10),
     subscription_limit(0 /*100000000*/),
     priority(false),
     secure_only(false),
     block_service_enabled(true),
+    block_encoding_topics(false),
     transaction_service_enabled(true),
+    transaction_address_topics(false),
+    transaction_batch_limit(0),
+    transaction_batch_microseconds(1000),
+    statistics_service_enabled(false),
     public_query_endpoint("tcp://*:9091"),
     public_heartbeat_endpoint("tcp://*:9092"),
     public_block_endpoint("tcp://*:9093"),
     public_transaction_endpoint("tcp://*:9094"),
+    public_transaction_batch_endpoint("tcp://*:9095"),
     secure_query_endpoint("tcp://*:9081"),
     secure_heartbeat_endpoint("tcp://*:9082"),
     secure_block_endpoint("tcp://*:9083"),
-    secure_transaction_endpoint("tcp://*:9084")
+    secure_transaction_endpoint("tcp://*:9084"),
+    secure_transaction_batch_endpoint("tcp://*:9085"),
+    statistics_endpoint("tcp://127.0.0.1:9090")
 {
 }
 
@@ -61,5 +75,16 @@ duration settings::subscription_expiration() const
     return minutes(subscription_expiration_minutes);
 }
 
+duration settings::transaction_batch_window() const
+{
+    return microseconds(transaction_batch_microseconds);
+}
+
+size_t settings::response_cache_size() const
+{
+    static constexpr size_t bytes_per_megabyte = 1024 * 1024;
+    return response_cache_megabytes * bytes_per_megabyte;
+}
+
 } // namespace server
 } // namespace libbitcoin
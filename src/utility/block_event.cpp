@@ -0,0 +1,183 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/block_event.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::chain;
+
+block_event::block_event(uint32_t height, block_const_ptr block)
+  : height_(height),
+    hash_(block->header().hash()),
+    block_(block),
+    extracted_(new std::once_flag[block->transactions().size()]),
+    keys_(block->transactions().size())
+{
+}
+
+uint32_t block_event::height() const
+{
+    return height_;
+}
+
+const hash_digest& block_event::hash() const
+{
+    return hash_;
+}
+
+block_const_ptr block_event::block() const
+{
+    return block_;
+}
+
+const data_chunk& block_event::data() const
+{
+    std::call_once(serialized_, &block_event::serialize, this);
+    return data_;
+}
+
+data_slice block_event::header_data() const
+{
+    const auto& block = data();
+    const auto size = block_->header().serialized_size(true);
+    return{ block.data(), block.data() + size };
+}
+
+const data_chunk& block_event::transaction_hashes() const
+{
+    std::call_once(hashed_, [this]()
+    {
+        const auto& txs = block_->transactions();
+        hashes_.resize(txs.size() * hash_size);
+        auto serial = make_unsafe_serializer(hashes_.begin());
+
+        for (const auto& tx: txs)
+            serial.write_hash(tx.hash());
+    });
+
+    return hashes_;
+}
+
+data_slice block_event::transaction_data(size_t index) const
+{
+    const auto& block = data();
+    const auto begin = block.data() + offsets_[index];
+    const auto end = index + 1 < offsets_.size() ?
+        block.data() + offsets_[index + 1] : block.data() + block.size();
+
+    return{ begin, end };
+}
+
+const block_event::key_list& block_event::keys(size_t index) const
+{
+    std::call_once(extracted_[index], [this, index]()
+    {
+        extract(keys_[index], block_->transactions()[index]);
+    });
+
+    return keys_[index];
+}
+
+// The transaction offsets are accumulated from the serialized sizes, as the
+// wire encoding of each transaction is its canonical message encoding.
+void block_event::serialize() const
+{
+    const auto& txs = block_->transactions();
+    data_ = block_->to_data(bc::message::version::level::canonical);
+    offsets_.reserve(txs.size());
+
+    auto offset = block_->header().serialized_size(true) +
+        bc::message::variable_uint_size(txs.size());
+
+    for (const auto& tx: txs)
+    {
+        offsets_.push_back(offset);
+        offset += tx.serialized_size(true);
+    }
+
+    BITCOIN_ASSERT(offset == data_.size());
+}
+
+// This parsing is duplicated by bc::database::data_base.
+void block_event::extract(key_list& out, const transaction& tx)
+{
+    uint32_t prefix;
+    const auto& outputs = tx.outputs();
+
+    if (outputs.empty())
+        return;
+
+    // see data_base::push_inputs
+    // Loop inputs and extract payment addresses.
+    for (const auto& input: tx.inputs())
+    {
+        // This is cached by database extraction (if indexed).
+        const auto address = input.address();
+
+        if (address)
+            out.push_back({ short_hash_size, address.hash() });
+    }
+
+    // see data_base::push_outputs
+    // Loop outputs and extract payment addresses.
+    for (const auto& output: outputs)
+    {
+        // This is cached by database extraction (if indexed).
+        const auto address = output.address();
+
+        if (address)
+            out.push_back({ short_hash_size, address.hash() });
+    }
+
+    // see data_base::push_stealth
+    // Loop output pairs and extract stealth payments.
+    for (size_t index = 0; index < (outputs.size() - 1); ++index)
+    {
+        const auto& ephemeral_script = outputs[index].script();
+        const auto& payment_output = outputs[index + 1];
+
+        // Try to extract a stealth prefix from the first output.
+        // Try to extract the payment address from the second output.
+        // The address is cached by database extraction (if indexed).
+        if (payment_output.address() &&
+            to_stealth_prefix(prefix, ephemeral_script))
+        {
+            // The prefix is keyed on its little endian bytes.
+            key value{ sizeof(prefix), {} };
+            const auto bytes = to_little_endian(prefix);
+            std::copy(bytes.begin(), bytes.end(), value.bytes.begin());
+            out.push_back(value);
+        }
+    }
+}
+
+data_slice block_event::key::slice() const
+{
+    return{ bytes.data(), bytes.data() + size };
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/chain_tip.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+chain_tip::ptr chain_tip::get() const
+{
+    return std::atomic_load(&state_);
+}
+
+void chain_tip::set(size_t height, const chain::header& header)
+{
+    std::atomic_store(&state_, create(height, header));
+}
+
+// A reorganization may publish before initialization completes, and wins.
+void chain_tip::initialize(size_t height, const chain::header& header)
+{
+    ptr expected;
+    std::atomic_compare_exchange_strong(&state_, &expected,
+        create(height, header));
+}
+
+chain_tip::ptr chain_tip::create(size_t height, const chain::header& header)
+{
+    return std::make_shared<const state>(state
+    {
+        height,
+        header.hash(),
+        header.to_data()
+    });
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,165 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/history_page.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::chain;
+
+// [ offset:4 ] [ height:4 ] [ kind:1 ] [ hash:32 ] [ index:4 ]
+const size_t history_page::cursor::size = sizeof(uint32_t) +
+    sizeof(uint32_t) + sizeof(uint8_t) + hash_size + sizeof(uint32_t);
+
+bool history_page::cursor::from_data(const data_chunk& data)
+{
+    if (data.size() != size)
+        return false;
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    offset = deserial.read_4_bytes_little_endian();
+    height = deserial.read_4_bytes_little_endian();
+    kind = deserial.read_byte();
+    hash = deserial.read_hash();
+    index = deserial.read_4_bytes_little_endian();
+    return true;
+}
+
+data_chunk history_page::cursor::to_data() const
+{
+    data_chunk data(size);
+    auto serial = make_unsafe_serializer(data.begin());
+    serial.write_4_bytes_little_endian(offset);
+    serial.write_4_bytes_little_endian(height);
+    serial.write_byte(kind);
+    serial.write_hash(hash);
+    serial.write_4_bytes_little_endian(index);
+    return data;
+}
+
+// A zero cursor (null hash) begins the history.
+bool history_page::cursor::first() const
+{
+    return hash == null_hash;
+}
+
+history_page::history_page(const cursor& position, size_t rows)
+  : position_(position), rows_(rows), start_(0), end_(0), more_(false)
+{
+}
+
+// The chain query has a row limit but no offset, so a page fetch reads every
+// row through the page, and memory for deep pages grows with the history
+// above the page.
+size_t history_page::limit() const
+{
+    return position_.first() ? rows_ : position_.offset + rows_ + rows_;
+}
+
+bool history_page::select(const history_compact::list& history,
+    size_t limit)
+{
+    const auto truncated = limit != 0 && history.size() == limit;
+    start_ = locate(history);
+    end_ = std::min(start_ + rows_, history.size());
+
+    // The limit excluded the cursor row or rows of the page.
+    if (truncated && count() < rows_)
+        return false;
+
+    // A truncated fetch may have more rows to follow.
+    more_ = count() > 0 && (end_ < history.size() || truncated);
+    return true;
+}
+
+size_t history_page::start() const
+{
+    return start_;
+}
+
+size_t history_page::end() const
+{
+    return end_;
+}
+
+size_t history_page::count() const
+{
+    return end_ - start_;
+}
+
+history_page::cursor history_page::next(
+    const history_compact::list& history) const
+{
+    if (!more_)
+        return{ 0, 0, 0, null_hash, 0 };
+
+    const auto& last = history[end_ - 1];
+    BITCOIN_ASSERT(end_ <= max_uint32);
+    BITCOIN_ASSERT(last.height <= max_uint32);
+
+    return
+    {
+        static_cast<uint32_t>(end_),
+        static_cast<uint32_t>(last.height),
+        static_cast<uint8_t>(last.kind),
+        last.point.hash(),
+        last.point.index()
+    };
+}
+
+// private
+//-----------------------------------------------------------------------------
+
+// The page begins after the cursor row. If that row has been reorganized out
+// of the chain, the page begins with the first row below its height.
+size_t history_page::locate(const history_compact::list& history) const
+{
+    if (position_.first())
+        return 0;
+
+    const auto matches = [this](const history_compact& row)
+    {
+        return row.height == position_.height &&
+            static_cast<uint8_t>(row.kind) == position_.kind &&
+            row.point.index() == position_.index &&
+            row.point.hash() == position_.hash;
+    };
+
+    const auto row = std::find_if(history.begin(), history.end(), matches);
+
+    if (row != history.end())
+        return std::distance(history.begin(), row) + 1;
+
+    const auto below = [this](const history_compact& entry)
+    {
+        return entry.height < position_.height;
+    };
+
+    return std::distance(history.begin(),
+        std::find_if(history.begin(), history.end(), below));
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/latency_histogram.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::chrono;
+
+static constexpr auto relaxed = std::memory_order_relaxed;
+
+latency_histogram::time_point latency_histogram::now()
+{
+    return asio::steady_clock::now();
+}
+
+latency_histogram::latency_histogram()
+  : count_(0), total_microseconds_(0)
+{
+    for (auto& bucket: buckets_)
+        bucket.store(0, relaxed);
+}
+
+// Counters are independent, a report may be momentarily inconsistent.
+void latency_histogram::record(const asio::duration& latency)
+{
+    const auto ticks = duration_cast<microseconds>(latency).count();
+    const auto microseconds = ticks < 0 ? 0 : static_cast<uint64_t>(ticks);
+
+    buckets_[bucket(microseconds)].fetch_add(1, relaxed);
+    total_microseconds_.fetch_add(microseconds, relaxed);
+    count_.fetch_add(1, relaxed);
+}
+
+void latency_histogram::record_since(const time_point& start)
+{
+    record(duration_cast<asio::duration>(now() - start));
+}
+
+uint64_t latency_histogram::count() const
+{
+    return count_.load(relaxed);
+}
+
+// Buckets are cumulative and labeled by inclusive upper bound (le). Latencies
+// are whole microseconds, so bucket n holds at most 2^(n+1)-1.
+void latency_histogram::report(std::ostream& output, const std::string& name,
+    const std::string& labels) const
+{
+    uint64_t cumulative = 0;
+
+    for (size_t index = 0; index < bucket_count - 1; ++index)
+    {
+        cumulative += buckets_[index].load(relaxed);
+        output
+            << name << "_bucket{" << labels << ",le=\""
+            << (uint64_t(1) << (index + 1)) - 1 << "\"} " << cumulative
+            << "\n";
+    }
+
+    output
+        << name << "_bucket{" << labels << ",le=\"+Inf\"} " << count() << "\n"
+        << name << "_sum{" << labels << "} "
+        << total_microseconds_.load(relaxed) << "\n"
+        << name << "_count{" << labels << "} " << count() << "\n";
+}
+
+// The index of the highest set bit, with zero and one in the first bucket.
+size_t latency_histogram::bucket(uint64_t microseconds)
+{
+    size_t index = 0;
+
+    while (microseconds > 1 && index < bucket_count - 1)
+    {
+        microseconds >>= 1;
+        ++index;
+    }
+
+    return index;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/publish_queue.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <bitcoin/protocol.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::protocol;
+
+static constexpr auto relaxed = std::memory_order_relaxed;
+
+publish_queue::publish_queue(const std::string& service,
+    const std::string& topic, size_t limit)
+  : labels_("service=\"" + service + "\",topic=\"" + topic + "\""),
+    limit_(limit),
+    queued_(0),
+    dropped_(0)
+{
+}
+
+// The limit is approximate, concurrent producers may briefly overshoot it.
+bool publish_queue::push(zmq::message&& message)
+{
+    if (limit_ != 0 && queue_.size() >= limit_)
+    {
+        dropped_.fetch_add(1, relaxed);
+        return false;
+    }
+
+    queued_.fetch_add(1, relaxed);
+    queue_.push(std::move(message));
+    return true;
+}
+
+bool publish_queue::pop(zmq::message& out)
+{
+    return queue_.pop(out);
+}
+
+size_t publish_queue::depth() const
+{
+    return queue_.size();
+}
+
+uint64_t publish_queue::dropped() const
+{
+    return dropped_.load(relaxed);
+}
+
+void publish_queue::report(std::ostream& output) const
+{
+    output
+        << "publish_queue_depth{" << labels_ << "} " << depth() << "\n"
+        << "publish_queued_total{" << labels_ << "} "
+        << queued_.load(relaxed) << "\n"
+        << "publish_dropped_total{" << labels_ << "} " << dropped() << "\n";
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/query_coalescer.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <boost/functional/hash_fwd.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::placeholders;
+
+void query_coalescer::execute(const message& request, send_handler handler,
+    command_handler command)
+{
+    key query{ request.command(), request.data() };
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    const auto it = pending_.find(query);
+
+    if (it != pending_.end())
+    {
+        it->second.emplace_back(request, handler);
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    pending_.emplace(query, waiters{});
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // The command may complete on this thread, so it is invoked unlocked.
+    command(request,
+        std::bind(&query_coalescer::complete,
+            this, std::move(query), _1, handler));
+}
+
+// Queries that arrive after this point begin a new execution.
+void query_coalescer::complete(const key& query, message&& response,
+    send_handler handler)
+{
+    waiters coalesced;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    const auto it = pending_.find(query);
+
+    if (it != pending_.end())
+    {
+        coalesced = std::move(it->second);
+        pending_.erase(it);
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (const auto& waiter: coalesced)
+        waiter.second(message(waiter.first, response.data()));
+
+    handler(std::move(response));
+}
+
+bool query_coalescer::key::operator==(const key& other) const
+{
+    return command == other.command && data == other.data;
+}
+
+size_t query_coalescer::key_hasher::operator()(const key& value) const
+{
+    size_t seed = std::hash<std::string>()(value.command);
+    boost::hash_range(seed, value.data.begin(), value.data.end());
+    return seed;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/query_statistics.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+static constexpr auto relaxed = std::memory_order_relaxed;
+
+query_statistics::command::command()
+  : requests(0), errors(0), received_bytes(0), sent_bytes(0)
+{
+}
+
+query_statistics::query_statistics(const std::string& service)
+  : service_(service)
+{
+}
+
+// Commands are attached by each worker as it starts, so this is not hot.
+query_statistics::command::ptr query_statistics::attach(
+    const std::string& command)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    auto& statistics = commands_[command];
+
+    if (!statistics)
+        statistics = std::make_shared<query_statistics::command>();
+
+    return statistics;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void query_statistics::report(std::ostream& output) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    for (const auto& entry: commands_)
+    {
+        const auto& statistics = *entry.second;
+        const auto labels = "service=\"" + service_ + "\",command=\"" +
+            entry.first + "\"";
+
+        output
+            << "query_requests_total{" << labels << "} "
+            << statistics.requests.load(relaxed) << "\n"
+            << "query_errors_total{" << labels << "} "
+            << statistics.errors.load(relaxed) << "\n"
+            << "query_received_bytes_total{" << labels << "} "
+            << statistics.received_bytes.load(relaxed) << "\n"
+            << "query_sent_bytes_total{" << labels << "} "
+            << statistics.sent_bytes.load(relaxed) << "\n";
+
+        statistics.execute.report(output,
+            "query_execute_microseconds", labels);
+        statistics.send_wait.report(output,
+            "query_send_wait_microseconds", labels);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace server
+} // namespace libbitcoin
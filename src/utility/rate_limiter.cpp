@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/rate_limiter.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <boost/functional/hash_fwd.hpp>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::chrono;
+
+const size_t rate_limiter::default_clients = 100000;
+
+// A burst less than one would never admit a request.
+rate_limiter::rate_limiter(uint32_t rate_per_second, uint32_t burst,
+    size_t clients)
+  : rate_(rate_per_second),
+    burst_(std::max(burst, uint32_t(1))),
+    clients_(clients),
+    admissions_(0),
+    shared_{ burst_, asio::steady_clock::now() }
+{
+}
+
+bool rate_limiter::disabled() const
+{
+    return rate_ == 0;
+}
+
+bool rate_limiter::admit(const data_chunk& identity)
+{
+    if (disabled())
+        return true;
+
+    const auto now = asio::steady_clock::now();
+
+    if (++admissions_ > buckets_.size())
+        purge(now);
+
+    const auto it = buckets_.find(identity);
+
+    if (it != buckets_.end())
+        return consume(it->second, now);
+
+    // Without a free bucket new clients are limited as one client. This
+    // bounds memory and the allowance of many new identities from one client.
+    // Buckets are freed by the amortized purge, not here, as a purge of all
+    // buckets for each request of a new identity would be quadratic.
+    if (buckets_.size() >= clients_)
+        return consume(shared_, now);
+
+    // A new client starts with a full bucket.
+    buckets_.emplace(identity, bucket{ burst_ - 1, now });
+    return true;
+}
+
+bool rate_limiter::consume(bucket& value, const time_point& now) const
+{
+    refill(value, now);
+
+    if (value.tokens < 1)
+        return false;
+
+    value.tokens -= 1;
+    return true;
+}
+
+void rate_limiter::refill(bucket& value, const time_point& now) const
+{
+    const auto elapsed = duration_cast<duration<double>>(now - value.updated);
+    value.tokens = std::min(burst_, value.tokens + elapsed.count() * rate_);
+    value.updated = now;
+}
+
+// A full bucket is equivalent to no bucket, so it is safe to remove.
+void rate_limiter::purge(const time_point& now)
+{
+    admissions_ = 0;
+
+    for (auto it = buckets_.begin(); it != buckets_.end();)
+    {
+        refill(it->second, now);
+
+        if (it->second.tokens >= burst_)
+            it = buckets_.erase(it);
+        else
+            ++it;
+    }
+}
+
+size_t rate_limiter::identity_hasher::operator()(const data_chunk& value) const
+{
+    return boost::hash_range(value.begin(), value.end());
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,187 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/response_cache.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <boost/functional/hash_fwd.hpp>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+// The approximate bookkeeping cost of an entry, in addition to its payload.
+static constexpr size_t entry_overhead = 128;
+
+response_cache::response_cache(size_t capacity)
+  : shard_capacity_(capacity / shard_count),
+    generation_(0)
+{
+    for (auto& partition: shards_)
+        partition.size = 0;
+}
+
+bool response_cache::disabled() const
+{
+    return shard_capacity_ == 0;
+}
+
+size_t response_cache::generation() const
+{
+    return generation_.load();
+}
+
+bool response_cache::find(data_chunk& out_payload, kind type,
+    const hash_digest& hash)
+{
+    if (disabled())
+        return false;
+
+    const key value{ type, hash };
+    auto& partition = locate(value);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(partition.mutex);
+
+    const auto it = partition.entries.find(value);
+
+    if (it == partition.entries.end())
+        return false;
+
+    // Move the entry to the most recently used position.
+    auto& order = partition.order;
+    order.splice(order.begin(), order, it->second.position);
+    out_payload = it->second.payload;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void response_cache::store(kind type, const hash_digest& hash,
+    const data_chunk& payload, size_t generation)
+{
+    const auto size = cost(payload);
+
+    if (size > shard_capacity_)
+        return;
+
+    const key value{ type, hash };
+    auto& partition = locate(value);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(partition.mutex);
+
+    // A reorganization since the fetch may have invalidated the payload.
+    // Invalidation advances the generation without a lock, then removes under
+    // each shard lock. So a store that observes the prior generation here
+    // precedes that removal, which then removes the stale entry.
+    if (generation != generation_.load())
+        return;
+
+    const auto it = partition.entries.find(value);
+
+    if (it != partition.entries.end())
+        erase(partition, it);
+
+    // Evict least recently used entries until the payload fits.
+    while (partition.size + size > shard_capacity_)
+        erase(partition, partition.entries.find(partition.order.back()));
+
+    partition.order.push_front(value);
+    partition.entries.emplace(value, entry{ payload, partition.order.begin() });
+    partition.size += size;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void response_cache::invalidate(const block_const_ptr_list& blocks)
+{
+    if (disabled() || blocks.empty())
+        return;
+
+    // Pending fetches captured the prior generation and will not be stored.
+    ++generation_;
+
+    for (const auto block: blocks)
+    {
+        const auto block_hash = block->header().hash();
+        remove({ kind::block_header, block_hash });
+        remove({ kind::block_transaction_hashes, block_hash });
+
+        for (const auto& tx: block->transactions())
+        {
+            const auto tx_hash = tx.hash();
+            remove({ kind::transaction, tx_hash });
+            remove({ kind::transaction_index, tx_hash });
+        }
+    }
+}
+
+// private
+//-----------------------------------------------------------------------------
+
+size_t response_cache::cost(const data_chunk& payload)
+{
+    return payload.size() + entry_overhead;
+}
+
+// Hashes are uniformly distributed, so any byte selects a shard.
+response_cache::shard& response_cache::locate(const key& value)
+{
+    return shards_[value.hash.front() % shard_count];
+}
+
+void response_cache::remove(const key& value)
+{
+    auto& partition = locate(value);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(partition.mutex);
+
+    const auto it = partition.entries.find(value);
+
+    if (it != partition.entries.end())
+        erase(partition, it);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The shard must be locked by the caller.
+void response_cache::erase(shard& partition, map::iterator it)
+{
+    partition.size -= cost(it->second.payload);
+    partition.order.erase(it->second.position);
+    partition.entries.erase(it);
+}
+
+bool response_cache::key::operator==(const key& other) const
+{
+    return type == other.type && hash == other.hash;
+}
+
+size_t response_cache::key_hasher::operator()(const key& value) const
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, static_cast<uint8_t>(value.type));
+    boost::hash_range(seed, value.hash.begin(), value.hash.end());
+    return seed;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -16,34 +16,43 @@
  * You should have received a copy of the GNU Affero General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <bitcoin/server/utility/address_key.hpp>
+#include <bitcoin/server/utility/transaction_event.hpp>
 
-#include <string>
+#include <mutex>
 #include <bitcoin/bitcoin.hpp>
-#include <bitcoin/server/messages/route.hpp>
+#include <bitcoin/server/utility/block_event.hpp>
 
 namespace libbitcoin {
 namespace server {
 
-address_key::address_key(const route& reply_to, const binary& prefix_filter)
-  : reply_to_(reply_to), prefix_filter_(prefix_filter)
+transaction_event::transaction_event(transaction_const_ptr tx)
+  : tx_(tx)
 {
 }
 
-bool address_key::operator==(const address_key& other) const
+transaction_const_ptr transaction_event::transaction() const
 {
-    return reply_to_ == other.reply_to_ &&
-        prefix_filter_ == other.prefix_filter_;
+    return tx_;
 }
 
-const route& address_key::reply_to() const
+const data_chunk& transaction_event::data() const
 {
-    return reply_to_;
+    std::call_once(serialized_, [this]()
+    {
+        data_ = tx_->to_data(bc::message::version::level::canonical);
+    });
+
+    return data_;
 }
 
-const binary& address_key::prefix_filter() const
+const block_event::key_list& transaction_event::keys() const
 {
-    return prefix_filter_;
+    std::call_once(extracted_, [this]()
+    {
+        block_event::extract(keys_, *tx_);
+    });
+
+    return keys_;
 }
 
 } // namespace server
@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/wakeup.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <bitcoin/protocol.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::protocol;
+
+// Each signal has its own inprocess endpoint.
+static config::endpoint unique_endpoint()
+{
+    static std::atomic<size_t> instances(0);
+    return config::endpoint("inproc://wakeup_" +
+        std::to_string(instances++));
+}
+
+wakeup::wakeup(zmq::authenticator& authenticator)
+  : endpoint_(unique_endpoint()),
+    authenticator_(authenticator),
+    pending_(false)
+{
+}
+
+bool wakeup::start(zmq::socket& receiver)
+{
+    auto ec = receiver.bind(endpoint_);
+
+    if (ec)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to bind wakeup signal to " << endpoint_ << " : "
+            << ec.message();
+        return false;
+    }
+
+    const auto sender = std::make_shared<zmq::socket>(authenticator_,
+        zmq::socket::role::pair);
+
+    ec = sender->connect(endpoint_);
+
+    if (ec)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to connect wakeup signal to " << endpoint_ << " : "
+            << ec.message();
+        return false;
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    sender_ = sender;
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Work may have been queued before the sender existed to signal it.
+    pending_.store(false);
+    notify();
+    return true;
+}
+
+// The sockets must be closed before the context, which is closed on stop.
+bool wakeup::stop(zmq::socket& receiver)
+{
+    socket_ptr sender;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    sender.swap(sender_);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    const auto sender_stop = !sender || sender->stop();
+    const auto receiver_stop = receiver.stop();
+    return sender_stop && receiver_stop;
+}
+
+// Work queued before the signal is cleared is taken after it, and work queued
+// after it signals again, so no work is left without a signal.
+void wakeup::clear(zmq::socket& receiver)
+{
+    zmq::message signal;
+    receiver.receive(signal);
+    pending_.store(false);
+}
+
+// Callers must queue their work before notifying.
+void wakeup::notify()
+{
+    if (pending_.exchange(true))
+        return;
+
+    zmq::message signal;
+    signal.enqueue();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    // The socket is not thread safe, so sends are serialized.
+    if (sender_)
+        sender_->send(signal);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace server
+} // namespace libbitcoin
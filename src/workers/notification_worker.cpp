@@ -19,11 +19,17 @@
 #include <bitcoin/server/workers/notification_worker.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/message.hpp>
@@ -47,16 +53,120 @@ using namespace bc::wallet;
 ////static const std::string address_stealth("address.stealth_update");
 ////static const std::string address_update("address.update");
 static const std::string address_update2("address.update2");
+static const std::string address_digest_update("address.digest_update");
+
+// The precision of subscription expiration.
+static const auto expiration_tick = asio::seconds(1);
+
+// The block transactions matched by each thread pool helper, at least.
+static constexpr size_t parallel_minimum = 64;
+
+// This class is not thread safe.
+// The notification payload following the code and sequence, shared by all
+// subscriptions matched by one transaction. It is built once, upon the first
+// match, from the transaction serialization, which is referenced in place.
+class notification_worker::transaction_suffix
+{
+public:
+    transaction_suffix(uint32_t height, const hash_digest& block_hash,
+        const data_slice& tx_data)
+      : height_(height), block_hash_(block_hash), tx_data_(tx_data)
+    {
+    }
+
+    // [ height:4 ]
+    // [ block_hash:32 ]
+    // [ tx:... ]
+    const data_chunk& data()
+    {
+        if (data_.empty())
+        {
+            data_.resize(sizeof(uint32_t) + hash_size + tx_data_.size());
+            auto serial = make_unsafe_serializer(data_.begin());
+            serial.write_4_bytes_little_endian(height_);
+            serial.write_hash(block_hash_);
+            serial.write_bytes(tx_data_);
+        }
+
+        return data_;
+    }
+
+private:
+    const uint32_t height_;
+    const hash_digest& block_hash_;
+    const data_slice tx_data_;
+    data_chunk data_;
+};
+
+// This class is thread safe.
+// The subscriptions matched by each transaction of a block. Any number of
+// threads may run the matching, claiming one transaction at a time. The caller
+// runs it as well, so it never waits on a helper that has yet to start, and a
+// late helper finds no transaction to claim. The caller must hold the
+// subscriptions exclusively until the wait completes, the helpers only read.
+class notification_worker::block_matches
+{
+public:
+    block_matches(const notification_worker& worker, block_event::ptr event)
+      : worker_(worker),
+        event_(event),
+        matches_(event->block()->transactions().size()),
+        next_(0),
+        completed_(0)
+    {
+    }
+
+    // Match transactions until none remain to be claimed (any thread).
+    void run()
+    {
+        const auto count = matches_.size();
+
+        // Keys are extracted once per event, by whichever notifier is first.
+        for (auto index = next_++; index < count; index = next_++)
+        {
+            worker_.match(matches_[index], event_->keys(index));
+
+            if (++completed_ == count)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_.notify_all();
+            }
+        }
+    }
+
+    // Wait until all transactions are matched.
+    void wait()
+    {
+        const auto count = matches_.size();
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this, count]() { return completed_ == count; });
+    }
+
+    // The matches of the transaction (once complete).
+    const subscription_list& matched(size_t index) const
+    {
+        return matches_[index];
+    }
+
+private:
+    const notification_worker& worker_;
+    const block_event::ptr event_;
+    std::vector<subscription_list> matches_;
+    std::atomic<size_t> next_;
+    std::atomic<size_t> completed_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+};
 
 notification_worker::notification_worker(zmq::authenticator& authenticator,
     server_node& node, bool secure)
   : worker(priority(node.server_settings().priority)),
     secure_(secure),
     settings_(node.server_settings()),
-    node_(node),
     authenticator_(authenticator),
-    address_subscriber_(std::make_shared<address_subscriber>(
-        node.thread_pool(), NAME "_address"))
+    dispatch_(node.thread_pool(), NAME "_dispatch"),
+    expirations_(expiration_tick),
+    wakeup_(authenticator)
     ////penetration_subscriber_(std::make_shared<penetration_subscriber>(
     ////    node.thread_pool(), NAME "_penetration"))
 {
@@ -65,18 +175,9 @@ notification_worker::notification_worker(zmq::authenticator& authenticator,
 // There is no unsubscribe so this class shouldn't be restarted.
 bool notification_worker::start()
 {
-    address_subscriber_->start();
     ////penetration_subscriber_->start();
 
-    // Subscribe to blockchain reorganizations.
-    node_.subscribe_blockchain(
-        std::bind(&notification_worker::handle_reorganization,
-            this, _1, _2, _3, _4));
-
-    // Subscribe to transaction pool acceptances.
-    node_.subscribe_transaction(
-        std::bind(&notification_worker::handle_transaction_pool,
-            this, _1, _2));
+    // Blocks and transactions are notified by the server's pipelines.
 
     ////// BUGBUG: this API was removed as could not adapt to changing peers.
     ////// Subscribe to all inventory messages from all peers.
@@ -91,10 +192,23 @@ bool notification_worker::start()
 // Because of closures in subscriber, must call stop from node stop handler.
 bool notification_worker::stop()
 {
-    address_subscriber_->stop();
+    static const auto code = error::service_stopped;
 
     // Unlike purge, stop will not propagate, since the context is closed.
-    address_subscriber_->invoke(error::service_stopped, {}, 0, {}, {});
+    // The lock is released before joining the worker thread, which purges.
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(mutex_);
+
+        subscriptions_.remove_if([this](const subscription_ptr& subscriber)
+        {
+            subscriber->removed = true;
+            notify(*subscriber, code);
+            return true;
+        });
+        ///////////////////////////////////////////////////////////////////////
+    }
 
     ////penetration_subscriber_->stop();
     ////penetration_subscriber_->invoke(error::service_stopped, 0, {}, {});
@@ -102,39 +216,59 @@ bool notification_worker::stop()
     return zmq::worker::stop();
 }
 
+// The poller timeout to the deadline, rounded up so that it has passed.
+static int32_t remaining(const asio::steady_clock::time_point& deadline)
+{
+    const auto now = asio::steady_clock::now();
+
+    if (now >= deadline)
+        return 1;
+
+    const auto period = std::chrono::duration_cast<asio::milliseconds>(
+        deadline - now) + asio::milliseconds(1);
+
+    return static_cast<int32_t>(period.count());
+}
+
 // Implement worker as a router to the query service.
 // The notification worker receives no messages from the query service.
+// Notifications are queued by any thread and sent from this thread, which is
+// the only one to use the socket, so the socket is connected only once.
 void notification_worker::work()
 {
     zmq::socket router(authenticator_, zmq::socket::role::router);
+    zmq::socket signal(authenticator_, zmq::socket::role::pair);
 
     // Connect socket to the service endpoint.
-    if (!started(connect(router)))
+    if (!started(connect(router) && wakeup_.start(signal)))
         return;
 
     zmq::poller poller;
     poller.add(router);
-    const auto interval = purge_interval_milliseconds();
+    poller.add(signal);
+    auto deadline = asio::steady_clock::now() + expiration_tick;
 
-    // We do not send/receive on the poller, we use its timer and context stop.
-    // Other threads connect and disconnect dynamically to send updates.
+    // We do not receive on the router, we use its context stop.
+    // Queued notifications are signaled, so the timer paces only expiration.
     while (!poller.terminated() && !stopped())
     {
-        // BUGBUG: this can fail on some platforms if interval is > 1000.
-        poller.wait(interval);
-        purge();
-    }
+        if (poller.wait(remaining(deadline)).contains(signal.id()))
+            wakeup_.clear(signal);
 
-    // Disconnect the socket and exit this thread.
-    finished(disconnect(router));
-}
+        deliver(router);
 
-int32_t notification_worker::purge_interval_milliseconds() const
-{
-    const int64_t minutes = settings_.subscription_expiration_minutes;
-    const int64_t milliseconds = minutes * 60 * 1000;
-    auto capped = std::min(milliseconds, static_cast<int64_t>(max_int32));
-    return static_cast<int32_t>(capped);
+        const auto now = asio::steady_clock::now();
+
+        if (now >= deadline)
+        {
+            purge();
+            deadline = now + expiration_tick;
+        }
+    }
+
+    // Disconnect the sockets and exit this thread.
+    const auto signal_stop = wakeup_.stop(signal);
+    finished(disconnect(router) && signal_stop);
 }
 
 // Connect/Disconnect.
@@ -180,84 +314,153 @@ bool notification_worker::disconnect(socket& router)
 // Pruning.
 // ----------------------------------------------------------------------------
 
-// Signal expired subscriptions to self-remove.
+// Remove and notify subscriptions as they expire, each tick of the wheel.
+// Only subscriptions scheduled on the elapsed ticks are visited.
 void notification_worker::purge()
 {
     static const auto code = error::channel_timeout;
+    const auto now = asio::steady_clock::now();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    expirations_.advance(now, [this, now](const subscription_ptr& subscriber)
+    {
+        // A shortened renewal leaves a stale later entry, which is ignored.
+        if (subscriber->removed || subscriber->scheduled > now)
+            return;
+
+        // Renewed since it was scheduled, so reschedule at the renewal.
+        if (subscriber->expires > now)
+        {
+            subscriber->scheduled = subscriber->expires;
+            expirations_.schedule(subscriber->scheduled, subscriber);
+            return;
+        }
+
+        remove(subscriber);
+        notify(*subscriber, code);
+    });
+    ///////////////////////////////////////////////////////////////////////////
 
-    address_subscriber_->purge(code, {}, 0, {}, {});
     ////penetration_subscriber_->purge(code, 0, {}, {});
 }
 
+// The subscription remains in the wheel until its scheduled time.
+void notification_worker::remove(const subscription_ptr& subscriber)
+{
+    subscriptions_.remove(subscriber->prefix_filter,
+        [&subscriber](const subscription_ptr& value)
+        {
+            return value == subscriber;
+        });
+
+    subscriber->removed = true;
+}
+
+bool notification_worker::unsubscribed() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return subscriptions_.empty();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 // Sending.
 // ----------------------------------------------------------------------------
 
+// Queue a notification to the subscriber (any thread).
 void notification_worker::send(const route& reply_to,
-    const std::string& command, uint32_t id, const data_chunk& payload)
+    const std::string& command, uint32_t id, data_chunk&& payload)
 {
-    const auto security = secure_ ? "secure" : "public";
-    const auto& endpoint = secure_ ? query_service::secure_notify :
-        query_service::public_notify;
-
-    zmq::socket notifier(authenticator_, zmq::socket::role::router);
-    auto ec = notifier.connect(endpoint);
+    // Notifications are formatted as query response messages.
+    notifications_.push(message(reply_to, command, id, std::move(payload)));
+    wakeup_.notify();
+}
 
-    if (ec == error::service_stopped)
-        return;
+// Send all queued notifications, in order of queueing.
+void notification_worker::deliver(socket& router)
+{
+    message notification(secure_);
 
-    if (ec)
+    while (notifications_.pop(notification))
     {
-        LOG_WARNING(LOG_SERVER)
-            << "Failed to connect " << security << " notification worker: "
-            << ec.message();
-        return;
-    }
-
-    // Notifications are formatted as query response messages.
-    message notification(reply_to, command, id, payload);
-    ec = notification.send(notifier);
+        const auto ec = notification.send(router);
 
-    if (ec && ec != error::service_stopped)
-        LOG_WARNING(LOG_SERVER)
-            << "Failed to send notification to "
-            << notification.route().display() << " " << ec.message();
+        if (ec && ec != error::service_stopped)
+            LOG_WARNING(LOG_SERVER)
+                << "Failed to send notification to "
+                << notification.route().display() << " " << ec.message();
+    }
 }
 
 // Handlers.
 // ----------------------------------------------------------------------------
 
-bool notification_worker::handle_address(const code& ec,
-    const binary& field, uint32_t height, const hash_digest& block_hash,
-    transaction_const_ptr tx, const route& reply_to, uint32_t id,
-    const binary& prefix_filter, sequence_ptr sequence)
+// The subscription must be locked by the caller.
+void notification_worker::notify(subscription& subscriber,
+    transaction_suffix& suffix)
 {
-    if (ec)
+    // [ code:4 ]
+    // [ sequence:2 ]
+    // [ height:4 ]
+    // [ block_hash:32 ]
+    // [ tx:... ]
+    // Only the code and sequence are specific to the subscription.
+    send(subscriber.reply_to, address_update2, subscriber.id, build_chunk(
     {
-        // [ code:4 ]
-        send(reply_to, address_update2, id, message::to_bytes(ec));
-        return false;
-    }
+        message::to_bytes(error::success),
+        to_little_endian(subscriber.sequence++),
+        suffix.data()
+    }));
+}
 
-    if (prefix_filter.is_prefix_of(field))
+// The subscription must be locked by the caller.
+void notification_worker::notify(subscription& subscriber,
+    const block_event& event, const std::vector<size_t>& matched)
+{
+    const auto hashes = subscriber.delivery == mode::block_hashes;
+    const auto& txs = event.block()->transactions();
+    auto size = sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint32_t) +
+        hash_size + sizeof(uint32_t);
+
+    for (const auto index: matched)
+        size += hashes ? hash_size : event.transaction_data(index).size();
+
+    // [ code:4 ]
+    // [ sequence:2 ]
+    // [ height:4 ]
+    // [ block_hash:32 ]
+    // [ count:4 ]
+    // [[ tx_hash:32 ]...] or [[ tx:... ]...]
+    data_chunk payload(size);
+    auto serial = make_unsafe_serializer(payload.begin());
+    serial.write_error_code(error::success);
+    serial.write_2_bytes_little_endian(subscriber.sequence++);
+    serial.write_4_bytes_little_endian(event.height());
+    serial.write_hash(event.hash());
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(matched.size()));
+
+    for (const auto index: matched)
     {
-        // [ code:4 ]
-        // [ sequence:2 ]
-        // [ height:4 ]
-        // [ block_hash:32 ]
-        // [ tx:... ]
-        send(reply_to, address_update2, id, build_chunk(
-        {
-            message::to_bytes(error::success),
-            to_little_endian(*sequence),
-            to_little_endian(height),
-            block_hash,
-            tx->to_data(bc::message::version::level::canonical)
-        }));
-
-        ++(*sequence);
+        if (hashes)
+            serial.write_hash(txs[index].hash());
+        else
+            serial.write_bytes(event.transaction_data(index));
     }
 
-    return true;
+    send(subscriber.reply_to, address_digest_update, subscriber.id,
+        std::move(payload));
+}
+
+void notification_worker::notify(const subscription& subscriber,
+    const code& ec)
+{
+    // [ code:4 ]
+    send(subscriber.reply_to, address_update2, subscriber.id,
+        message::to_bytes(ec));
 }
 
 // Subscribers.
@@ -266,35 +469,72 @@ bool notification_worker::handle_address(const code& ec,
 // Subscribe to address and stealth prefix notifications.
 // Each delegate must connect to the appropriate query notification endpoint.
 code notification_worker::subscribe_address(const route& reply_to, uint32_t id,
-    const binary& prefix_filter, bool unsubscribe)
+    const binary& prefix_filter, uint32_t ttl_seconds, mode delivery,
+    bool unsubscribe)
 {
-    const address_key key(reply_to, prefix_filter);
+    if (stopped())
+        return error::service_stopped;
+
+    const auto same_route = [&reply_to](const subscription_ptr& subscriber)
+    {
+        return subscriber->reply_to == reply_to;
+    };
+
+    // The client may request a shorter expiration than the configured one.
+    const auto limit = settings_.subscription_expiration();
+    const auto ttl = ttl_seconds == 0 ? limit :
+        std::min<asio::duration>(asio::seconds(ttl_seconds), limit);
+
+    const auto expires = asio::steady_clock::now() + ttl;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto existing = subscriptions_.find(prefix_filter, same_route);
 
     if (unsubscribe)
     {
-        // Cause stored handler to be invoked but with specified error code.
-        address_subscriber_->unsubscribe(key, error::service_stopped, {}, 0,
-            {}, {});
+        // Notify the removed subscription with the stopped code.
+        if (existing)
+        {
+            remove(existing);
+            notify(*existing, error::service_stopped);
+        }
+
+        return error::success;
+    }
+
+    // A resubscription renews the subscription, retaining its sequence.
+    // Only a renewal that shortens the expiration must be scheduled.
+    if (existing)
+    {
+        existing->delivery = delivery;
+        existing->expires = expires;
+
+        if (expires < existing->scheduled)
+        {
+            existing->scheduled = expires;
+            expirations_.schedule(expires, existing);
+        }
+
         return error::success;
     }
 
     // This allows resubscriptions at the service limit.
-    if (address_subscriber_->limited(key, settings_.subscription_limit))
+    if (subscriptions_.size() >= settings_.subscription_limit)
         return error::oversubscribed;
 
     // The sequence enables the client to detect dropped messages.
-    const auto sequence = std::make_shared<uint16_t>(0);
-    const auto& duration = settings_.subscription_expiration();
+    const auto subscriber = std::make_shared<subscription>(
+        subscription{ reply_to, id, prefix_filter, 0, delivery, expires,
+            expires, false });
 
-    auto handler =
-        std::bind(&notification_worker::handle_address,
-            this, _1, _2, _3, _4, _5, reply_to, id, prefix_filter,
-                sequence);
+    subscriptions_.insert(prefix_filter, subscriber);
+    expirations_.schedule(expires, subscriber);
 
-    // If the service is stopped a notification will result.
-    address_subscriber_->subscribe(std::move(handler),
-        key, duration, error::service_stopped, {}, 0, {}, {});
     return error::success;
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 ////// Subscribe to transaction penetration notifications.
@@ -319,51 +559,77 @@ code notification_worker::subscribe_address(const route& reply_to, uint32_t id,
 // Notification (via blockchain).
 // ----------------------------------------------------------------------------
 
-bool notification_worker::handle_reorganization(const code& ec,
-    size_t fork_height, block_const_ptr_list_const_ptr new_blocks,
-    block_const_ptr_list_const_ptr)
+// Blocks are notified in order, the events are shared with the publishers.
+void notification_worker::notify_blocks(const block_event::list& events)
 {
-    if (stopped() || ec == error::service_stopped)
-        return false;
-
-    if (ec)
-    {
-        LOG_WARNING(LOG_SERVER)
-            << "Failure handling new block: " << ec.message();
-
-        // Don't let a failure here prevent prevent future notifications.
-        return true;
-    }
-
-    if (address_subscriber_->empty())
-        return true;
-
-    // Blockchain height is size_t but obelisk protocol is 32 bit.
-    auto fork_height32 = safe_unsigned<uint32_t>(fork_height);
-
-    for (const auto block: *new_blocks)
-        notify_block(safe_increment(fork_height32), block);
+    if (stopped() || unsubscribed())
+        return;
 
-    return true;
+    for (const auto& event: events)
+        notify_block(event);
 }
 
-void notification_worker::notify_block(uint32_t height,
-    block_const_ptr block)
+// Matching is shared with the thread pool by transaction, under exclusive
+// lock, and then sequences are assigned serially in block order.
+void notification_worker::notify_block(block_event::ptr event)
 {
     if (stopped())
         return;
 
-    const auto block_hash = block->header().hash();
+    const auto height = event->height();
+    const auto& block_hash = event->hash();
+    const auto count = event->block()->transactions().size();
+    const auto matches = std::make_shared<block_matches>(*this, event);
+    const auto helpers = std::min(dispatch_.size(), count / parallel_minimum);
 
-    for (const auto& tx: block->transactions())
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (size_t helper = 0; helper < helpers; ++helper)
+        dispatch_.concurrent([matches]() { matches->run(); });
+
+    matches->run();
+    matches->wait();
+
+    // Digest subscriptions in order of first match, with their matches.
+    std::vector<std::pair<subscription_ptr, std::vector<size_t>>> digests;
+    std::unordered_map<subscription_ptr, size_t> positions;
+
+    for (size_t index = 0; index < count; ++index)
     {
-        // TODO: use shared pointers for block members to avoid copying.
-        auto pointer = std::make_shared<const bc::message::transaction>(tx);
+        const auto& matched = matches->matched(index);
+
+        if (matched.empty())
+            continue;
+
+        // The transaction is referenced within the block serialization.
+        transaction_suffix suffix(height, block_hash,
+            event->transaction_data(index));
+
+        for (const auto& subscriber: matched)
+        {
+            if (subscriber->delivery == mode::transaction)
+            {
+                notify(*subscriber, suffix);
+                continue;
+            }
+
+            const auto it = positions.emplace(subscriber, digests.size());
+
+            if (it.second)
+                digests.push_back({ subscriber, {} });
+
+            digests[it.first->second].second.push_back(index);
+        }
 
         ////const auto tx_hash = tx->hash();
-        notify_transaction(height, block_hash, pointer);
         ////notify_penetration(height, block_hash, tx_hash);
     }
+
+    for (const auto& digest: digests)
+        notify(*digest.first, *event, digest.second);
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 // Notification (via transaction inventory).
@@ -403,94 +669,54 @@ void notification_worker::notify_block(uint32_t height,
 // Notification (via mempool and blockchain).
 // ----------------------------------------------------------------------------
 
-bool notification_worker::handle_transaction_pool(const code& ec,
-    transaction_const_ptr tx)
+// Pool transactions are notified with zero height and null block hash.
+void notification_worker::notify_transaction(const transaction_event& event)
 {
-    if (stopped() || ec == error::service_stopped)
-        return false;
+    if (stopped() || unsubscribed())
+        return;
 
-    if (ec)
-    {
-        LOG_WARNING(LOG_SERVER)
-            << "Failure handling new transaction: " << ec.message();
+    subscription_list matched;
 
-        // Don't let a failure here prevent future notifications.
-        return true;
-    }
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
 
-    if (address_subscriber_->empty())
-        return true;
+    match(matched, event.keys());
 
-    notify_transaction(0, null_hash, tx);
-    return true;
+    // The transaction is serialized once for all notifiers and publishers.
+    if (!matched.empty())
+        notify(matched, 0, null_hash, event.data());
+    ///////////////////////////////////////////////////////////////////////////
 }
 
-// This parsing is duplicated by bc::database::data_base.
-void notification_worker::notify_transaction(uint32_t height,
-    const hash_digest& block_hash, transaction_const_ptr tx)
+// The subscriptions must be locked by the caller, this does not modify them.
+void notification_worker::match(subscription_list& out,
+    const block_event::key_list& keys) const
 {
-    uint32_t prefix;
-
-    // TODO: move full integer and array constructors into binary.
-    static constexpr size_t prefix_bits = sizeof(prefix) * byte_bits;
-    static constexpr size_t address_bits = short_hash_size * byte_bits;
-    const auto& outputs = tx->outputs();
-
-    if (stopped() || outputs.empty())
-        return;
-
-    // see data_base::push_inputs
-    // Loop inputs and extract payment addresses.
-    for (const auto& input: tx->inputs())
+    // Each key is matched only against the subscriptions whose prefix covers
+    // it, in place and without allocation.
+    const auto collect = [&out](const subscription_ptr& subscriber)
     {
-        // This is cached by database extraction (if indexed).
-        const auto address = input.address();
+        out.push_back(subscriber);
+    };
 
-        if (address)
-        {
-            const binary field(address_bits, address.hash());
-            notify_address(field, height, block_hash, tx);
-        }
-    }
-
-    // see data_base::push_outputs
-    // Loop outputs and extract payment addresses.
-    for (const auto& output: outputs)
-    {
-        // This is cached by database extraction (if indexed).
-        const auto address = output.address();
+    for (const auto& key: keys)
+        subscriptions_.match(key.slice(), collect);
 
-        if (address)
-        {
-            const binary field(address_bits, address.hash());
-            notify_address(field, height, block_hash, tx);
-        }
-    }
-
-    // see data_base::push_stealth
-    // Loop output pairs and extract stealth payments.
-    for (size_t index = 0; index < (outputs.size() - 1); ++index)
-    {
-        const auto& ephemeral_script = outputs[index].script();
-        const auto& payment_output = outputs[index + 1];
-
-        // Try to extract a stealth prefix from the first output.
-        // Try to extract the payment address from the second output.
-        // The address is cached by database extraction (if indexed).
-        if (payment_output.address() &&
-            to_stealth_prefix(prefix, ephemeral_script))
-        {
-            const binary field(prefix_bits, to_little_endian(prefix));
-            notify_address(field, height, block_hash, tx);
-        }
-    }
+    // A subscription matched by several keys is notified of the tx once.
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
 }
 
-void notification_worker::notify_address(const binary& field, uint32_t height,
-    const hash_digest& block_hash, transaction_const_ptr tx)
+// The subscriptions must be locked by the caller, so sequences are in order.
+void notification_worker::notify(const subscription_list& matches,
+    uint32_t height, const hash_digest& block_hash, const data_slice& tx_data)
 {
-    static const auto code = error::success;
-    address_subscriber_->relay(code, field, height, block_hash, tx);
+    // The suffix is shared by all matches of the transaction.
+    transaction_suffix suffix(height, block_hash, tx_data);
+
+    for (const auto& subscriber: matches)
+        notify(*subscriber, suffix);
 }
 
 ////// v3.x
@@ -18,8 +18,13 @@
  */
 #include <bitcoin/server/workers/query_worker.hpp>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
+#include <utility>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/interface/address.hpp>
@@ -28,6 +33,7 @@
 #include <bitcoin/server/interface/transaction_pool.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/utility/mpsc_queue.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -35,14 +41,67 @@ namespace server {
 using namespace std::placeholders;
 using namespace bc::protocol;
 
+// This class is thread safe.
+// Queue responses for the worker thread and wake it to send them. The queue
+// and signal are shared, as a chain completion may outlive the worker.
+class query_worker::query_completion
+{
+public:
+    query_completion(response_queue::ptr responses, wakeup_ptr wakeup,
+        query_statistics::command::ptr statistics)
+      : responses_(responses),
+        wakeup_(wakeup),
+        statistics_(statistics),
+        started_(latency_histogram::now())
+    {
+    }
+
+    void push(message&& response)
+    {
+        if (statistics_)
+            record(response);
+
+        const auto queued = latency_histogram::now();
+        responses_->push({ std::move(response), statistics_, queued });
+        wakeup_->notify();
+    }
+
+private:
+    // All responses begin with a four byte code.
+    void record(const message& response)
+    {
+        static constexpr auto relaxed = std::memory_order_relaxed;
+        const auto& data = response.data();
+
+        if (data.size() >= sizeof(uint32_t))
+        {
+            auto deserial = make_safe_deserializer(data.begin(), data.end());
+
+            if (deserial.read_error_code())
+                statistics_->errors.fetch_add(1, relaxed);
+        }
+
+        statistics_->sent_bytes.fetch_add(data.size(), relaxed);
+        statistics_->execute.record_since(started_);
+    }
+
+    response_queue::ptr responses_;
+    wakeup_ptr wakeup_;
+    query_statistics::command::ptr statistics_;
+    const latency_histogram::time_point started_;
+};
+
 query_worker::query_worker(zmq::authenticator& authenticator,
-    server_node& node, bool secure)
+    server_node& node, bool secure, bool heavy)
   : worker(priority(node.server_settings().priority)),
     secure_(secure),
+    heavy_(heavy),
     verbose_(node.network_settings().verbose),
     settings_(node.server_settings()),
     node_(node),
-    authenticator_(authenticator)
+    authenticator_(authenticator),
+    responses_(std::make_shared<response_queue>()),
+    wakeup_(std::make_shared<wakeup>(authenticator))
 {
     // The same interface is attached to the secure and public interfaces.
     attach_interface();
@@ -51,25 +110,38 @@ query_worker::query_worker(zmq::authenticator& authenticator,
 // Implement worker as a router to the query service.
 // v2 libbitcoin-client DEALER does not add delimiter frame.
 // The router drops messages for lost peers (query service) and high water.
+// Any number of queries may be pending, their responses are queued by chain
+// threads and sent from this thread, which is the only one to use the socket.
 void query_worker::work()
 {
     zmq::socket router(authenticator_, zmq::socket::role::router);
+    zmq::socket signal(authenticator_, zmq::socket::role::pair);
 
     // Connect socket to the service endpoint.
-    if (!started(connect(router)))
+    if (!started(connect(router) && wakeup_->start(signal)))
         return;
 
     zmq::poller poller;
     poller.add(router);
+    poller.add(signal);
 
+    // Queued responses are signaled, so the thread blocks while none are.
     while (!poller.terminated() && !stopped())
     {
-        if (poller.wait().contains(router.id()))
+        const auto signaled = poller.wait();
+
+        if (signaled.contains(signal.id()))
+            wakeup_->clear(signal);
+
+        if (signaled.contains(router.id()))
             query(router);
+
+        respond(router);
     }
 
-    // Disconnect the socket and exit this thread.
-    finished(disconnect(router));
+    // Disconnect the sockets and exit this thread.
+    const auto signal_stop = wakeup_->stop(signal);
+    finished(disconnect(router) && signal_stop);
 }
 
 // Connect/Disconnect.
@@ -78,8 +150,11 @@ void query_worker::work()
 bool query_worker::connect(zmq::socket& router)
 {
     const auto security = secure_ ? "secure" : "public";
-    const auto& endpoint = secure_ ? query_service::secure_query :
-        query_service::public_query;
+    const auto& endpoint = secure_ ?
+        (heavy_ ? query_service::secure_heavy_query :
+            query_service::secure_query) :
+        (heavy_ ? query_service::public_heavy_query :
+            query_service::public_query);
 
     const auto ec = router.connect(endpoint);
 
@@ -120,24 +195,30 @@ void query_worker::query(zmq::socket& router)
     if (stopped())
         return;
 
-    // TODO: rewrite the serial blockchain interface to avoid callbacks.
-    // We are using a closure vs. bind to take advantage of move arg syntax.
-    const auto sender = [&router](message&& response)
-    {
-        const auto ec = response.send(router);
-
-        if (ec && ec != error::service_stopped)
-            LOG_WARNING(LOG_SERVER)
-                << "Failed to send query response to "
-                << response.route().display() << " " << ec.message();
-    };
-
     message request(secure_);
     const auto ec = request.receive(router);
 
     if (ec == error::service_stopped)
         return;
 
+    // Locate the request handler for this command.
+    const auto handler = command_handlers_.find(request.command());
+    const auto found = !ec && handler != command_handlers_.end();
+
+    // Statistics are recorded only for attached commands.
+    const auto statistics = found ? command_statistics_[request.command()] :
+        query_statistics::command::ptr();
+
+    const auto completion = std::make_shared<query_completion>(responses_,
+        wakeup_, statistics);
+
+    // The sender may be invoked on any thread, so it only queues responses.
+    // We are using a closure vs. bind to take advantage of move arg syntax.
+    const auto sender = [completion](message&& response)
+    {
+        completion->push(std::move(response));
+    };
+
     if (ec)
     {
         LOG_DEBUG(LOG_SERVER)
@@ -149,10 +230,7 @@ void query_worker::query(zmq::socket& router)
         return;
     }
 
-    // Locate the request handler for this command.
-    const auto handler = command_handlers_.find(request.command());
-
-    if (handler == command_handlers_.end())
+    if (!found)
     {
         LOG_DEBUG(LOG_SERVER)
             << "Invalid query command from " << request.route().display();
@@ -161,6 +239,10 @@ void query_worker::query(zmq::socket& router)
         return;
     }
 
+    statistics->requests.fetch_add(1, std::memory_order_relaxed);
+    statistics->received_bytes.fetch_add(request.data().size(),
+        std::memory_order_relaxed);
+
     if (verbose_)
         LOG_INFO(LOG_SERVER)
             << "Query " << request.command() << " from "
@@ -175,6 +257,26 @@ void query_worker::query(zmq::socket& router)
     query_execute(request, sender);
 }
 
+// Send all queued responses, in order of completion.
+void query_worker::respond(zmq::socket& router)
+{
+    queued_response queued{ message(secure_), nullptr, {} };
+
+    while (responses_->pop(queued))
+    {
+        if (queued.statistics)
+            queued.statistics->send_wait.record_since(queued.queued);
+
+        auto& response = queued.response;
+        const auto ec = response.send(router);
+
+        if (ec && ec != error::service_stopped)
+            LOG_WARNING(LOG_SERVER)
+                << "Failed to send query response to "
+                << response.route().display() << " " << ec.message();
+    }
+}
+
 // Query Interface.
 // ----------------------------------------------------------------------------
 
@@ -184,10 +286,28 @@ void query_worker::query(zmq::socket& router)
         std::bind(&bc::server::class_name::method_name, \
             std::ref(node), _1, _2));
 
+// Only read-only commands with a single response may be coalesced.
+#define COALESCE(class_name, method_name, node) \
+    attach(#class_name "." #method_name, \
+        coalesce(std::bind(&bc::server::class_name::method_name, \
+            std::ref(node), _1, _2)));
+
 void query_worker::attach(const std::string& command,
     command_handler handler)
 {
     command_handlers_[command] = handler;
+    command_statistics_[command] = node_.statistics(secure_).attach(command);
+}
+
+// Concurrent identical queries share one execution across all workers.
+query_worker::command_handler query_worker::coalesce(command_handler handler)
+{
+    auto& coalescer = node_.coalescer();
+
+    return [&coalescer, handler](const message& request, send_handler sender)
+    {
+        coalescer.execute(request, sender, handler);
+    };
 }
 
 //=============================================================================
@@ -209,6 +329,8 @@ void query_worker::attach(const std::string& command,
 // blockchain.broadcast is new in v3 (blocks).
 // blockchain.fetch_history is obsoleted in v3 (hash reversal).
 // blockchain.fetch_history2 is new in v3.
+// blockchain.fetch_history3 is new in v3 (batched).
+// blockchain.fetch_history4 is new in v3 (paged).
 // blockchain.fetch_stealth is obsoleted in v3 (hash reversal).
 // blockchain.fetch_stealth2 is new in v3.
 // blockchain.fetch_stealth_transaction is new in v3 (safe version).
@@ -223,37 +345,40 @@ void query_worker::attach(const std::string& command,
 // Interface class.method names must match protocol (do not change).
 void query_worker::attach_interface()
 {
-    ////ATTACH(address, renew, node_);                          // obsoleted
-    ////ATTACH(address, subscribe, node_);                      // obsoleted
-    ////ATTACH(address, fetch_history, node_);                  // obsoleted
-    ATTACH(address, subscribe2, node_);                         // new
-    ATTACH(address, unsubscribe2, node_);                       // new
-
-    ////ATTACH(blockchain, fetch_stealth, node_);               // obsoleted
-    ////ATTACH(blockchain, fetch_history, node_);               // obsoleted
-    ATTACH(blockchain, fetch_block_header, node_);              // original
-    ATTACH(blockchain, fetch_block_height, node_);              // original
-    ATTACH(blockchain, fetch_block_transaction_hashes, node_);  // original
-    ATTACH(blockchain, fetch_last_height, node_);               // original
-    ATTACH(blockchain, fetch_transaction, node_);               // original
-    ATTACH(blockchain, fetch_transaction_index, node_);         // original
-    ATTACH(blockchain, fetch_spend, node_);                     // original
-    ATTACH(blockchain, fetch_history2, node_);                  // new
-    ATTACH(blockchain, fetch_stealth2, node_);                  // new
-    ATTACH(blockchain, fetch_stealth_transaction, node_);       // new
-    ATTACH(blockchain, broadcast, node_);                       // new
-    ATTACH(blockchain, validate, node_);                        // new
-
-    ////ATTACH(transaction_pool, validate, node_);              // obsoleted
-    ATTACH(transaction_pool, fetch_transaction, node_);         // enhanced
-    ATTACH(transaction_pool, broadcast, node_);                 // new
-    ATTACH(transaction_pool, validate2, node_);                 // new
-
-    ////ATTACH(protocol, broadcast_transaction, node_);         // obsoleted
-    ATTACH(protocol, total_connections, node_);                 // original
+    ////ATTACH(address, renew, node_);                            // obsoleted
+    ////ATTACH(address, subscribe, node_);                        // obsoleted
+    ////ATTACH(address, fetch_history, node_);                    // obsoleted
+    ATTACH(address, subscribe2, node_);                           // new
+    ATTACH(address, unsubscribe2, node_);                         // new
+
+    ////ATTACH(blockchain, fetch_stealth, node_);                 // obsoleted
+    ////ATTACH(blockchain, fetch_history, node_);                 // obsoleted
+    COALESCE(blockchain, fetch_block_header, node_);              // original
+    COALESCE(blockchain, fetch_block_height, node_);              // original
+    COALESCE(blockchain, fetch_block_transaction_hashes, node_);  // original
+    ATTACH(blockchain, fetch_last_height, node_);                 // original
+    COALESCE(blockchain, fetch_transaction, node_);               // original
+    COALESCE(blockchain, fetch_transaction_index, node_);         // original
+    COALESCE(blockchain, fetch_spend, node_);                     // original
+    COALESCE(blockchain, fetch_history2, node_);                  // new
+    COALESCE(blockchain, fetch_history3, node_);                  // new
+    ATTACH(blockchain, fetch_history4, node_);                    // new
+    COALESCE(blockchain, fetch_stealth2, node_);                  // new
+    COALESCE(blockchain, fetch_stealth_transaction, node_);       // new
+    ATTACH(blockchain, broadcast, node_);                         // new
+    ATTACH(blockchain, validate, node_);                          // new
+
+    ////ATTACH(transaction_pool, validate, node_);                // obsoleted
+    COALESCE(transaction_pool, fetch_transaction, node_);         // enhanced
+    ATTACH(transaction_pool, broadcast, node_);                   // new
+    ATTACH(transaction_pool, validate2, node_);                   // new
+
+    ////ATTACH(protocol, broadcast_transaction, node_);           // obsoleted
+    ATTACH(protocol, total_connections, node_);                   // original
 }
 
 #undef ATTACH
+#undef COALESCE
 
 } // namespace server
 } // namespace libbitcoin
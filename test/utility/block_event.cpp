@@ -0,0 +1,184 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::chain;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(block_event_tests)
+
+static const short_hash hash_a{ { 0x11 } };
+static const short_hash hash_b{ { 0x22 } };
+static const short_hash hash_c{ { 0x33 } };
+static const data_chunk ephemeral_key(hash_size, 0x44);
+
+static data_chunk to_chunk(const data_slice& slice)
+{
+    return data_chunk(slice.begin(), slice.end());
+}
+
+static data_chunk to_chunk(const short_hash& hash)
+{
+    return data_chunk(hash.begin(), hash.end());
+}
+
+static script ephemeral_script()
+{
+    return script(script::to_null_data_pattern(ephemeral_key));
+}
+
+// A coinbase paying to a key hash and a script hash.
+static transaction make_coinbase()
+{
+    const input::list inputs
+    {
+        { output_point(null_hash, point::null_index), script(), 0 }
+    };
+
+    const output::list outputs
+    {
+        { 50, script(script::to_pay_key_hash_pattern(hash_a)) },
+        { 25, script(script::to_pay_script_hash_pattern(hash_c)) }
+    };
+
+    return transaction(1, 0, inputs, outputs);
+}
+
+// A stealth payment, an ephemeral key output followed by its payment.
+static transaction make_stealth(const hash_digest& previous)
+{
+    const input::list inputs
+    {
+        { output_point(previous, 0), script(), 0 }
+    };
+
+    const output::list outputs
+    {
+        { 0, ephemeral_script() },
+        { 40, script(script::to_pay_key_hash_pattern(hash_b)) }
+    };
+
+    return transaction(1, 0, inputs, outputs);
+}
+
+static block_const_ptr make_block()
+{
+    const auto coinbase = make_coinbase();
+    const transaction::list transactions
+    {
+        coinbase,
+        make_stealth(coinbase.hash())
+    };
+
+    const chain::header header(1, null_hash, null_hash, 42, 0x1d00ffff, 7);
+    return std::make_shared<const bc::message::block>(header, transactions);
+}
+
+static void require_data(const block_event& event)
+{
+    const auto& block = *event.block();
+    const auto& transactions = block.transactions();
+    BOOST_REQUIRE(event.data() ==
+        block.to_data(bc::message::version::level::canonical));
+    BOOST_REQUIRE(to_chunk(event.header_data()) == block.header().to_data());
+
+    for (size_t index = 0; index < transactions.size(); ++index)
+        BOOST_REQUIRE(to_chunk(event.transaction_data(index)) ==
+            transactions[index].to_data());
+}
+
+BOOST_AUTO_TEST_CASE(block_event__construct__block__height_and_hash)
+{
+    const auto block = make_block();
+    const block_event event(42, block);
+    BOOST_REQUIRE_EQUAL(event.height(), 42u);
+    BOOST_REQUIRE(event.hash() == block->header().hash());
+    BOOST_REQUIRE(event.block() == block);
+}
+
+BOOST_AUTO_TEST_CASE(block_event__data__genesis__header_and_transaction_slices)
+{
+    const auto genesis = std::make_shared<const bc::message::block>(
+        chain::block::genesis_mainnet());
+    const block_event event(0, genesis);
+    BOOST_REQUIRE_EQUAL(genesis->transactions().size(), 1u);
+    require_data(event);
+}
+
+BOOST_AUTO_TEST_CASE(block_event__data__transactions__header_and_transaction_slices)
+{
+    const block_event event(1, make_block());
+    BOOST_REQUIRE_EQUAL(event.block()->transactions().size(), 2u);
+    require_data(event);
+}
+
+BOOST_AUTO_TEST_CASE(block_event__transaction_hashes__transactions__concatenated_in_order)
+{
+    const auto block = make_block();
+    const block_event event(1, block);
+    const auto& transactions = block->transactions();
+    const auto& hashes = event.transaction_hashes();
+    BOOST_REQUIRE_EQUAL(hashes.size(), transactions.size() * hash_size);
+
+    for (size_t index = 0; index < transactions.size(); ++index)
+    {
+        const auto hash = transactions[index].hash();
+        const auto begin = hashes.begin() + index * hash_size;
+        BOOST_REQUIRE(std::equal(hash.begin(), hash.end(), begin));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(block_event__keys__coinbase__output_addresses)
+{
+    const block_event event(1, make_block());
+    const auto& keys = event.keys(0);
+    BOOST_REQUIRE_EQUAL(keys.size(), 2u);
+    BOOST_REQUIRE(to_chunk(keys[0].slice()) == to_chunk(hash_a));
+    BOOST_REQUIRE(to_chunk(keys[1].slice()) == to_chunk(hash_c));
+}
+
+BOOST_AUTO_TEST_CASE(block_event__keys__stealth__address_and_little_endian_prefix)
+{
+    const block_event event(1, make_block());
+    const auto& keys = event.keys(1);
+    BOOST_REQUIRE_EQUAL(keys.size(), 2u);
+    BOOST_REQUIRE(to_chunk(keys[0].slice()) == to_chunk(hash_b));
+
+    uint32_t prefix;
+    BOOST_REQUIRE(to_stealth_prefix(prefix, ephemeral_script()));
+    const auto bytes = to_little_endian(prefix);
+    BOOST_REQUIRE(to_chunk(keys[1].slice()) ==
+        data_chunk(bytes.begin(), bytes.end()));
+}
+
+BOOST_AUTO_TEST_CASE(block_event__extract__no_outputs__none)
+{
+    const transaction tx(1, 0, input::list{}, output::list{});
+    block_event::key_list keys;
+    block_event::extract(keys, tx);
+    BOOST_REQUIRE(keys.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,238 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::chain;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(history_page_tests)
+
+typedef history_page::cursor cursor;
+
+static const cursor zero_cursor{ 0, 0, 0, null_hash, 0 };
+
+// Each row is identified by its tag, as both point hash and index.
+static history_compact make_row(uint32_t height, uint8_t tag)
+{
+    history_compact row;
+    row.kind = point_kind::output;
+    row.point = point(hash_digest{ { tag } }, tag);
+    row.height = height;
+    row.value = tag;
+    return row;
+}
+
+// Ten rows, newest first, two at each height from 50 down to 10.
+static history_compact::list make_history()
+{
+    history_compact::list history;
+
+    for (uint8_t tag = 1; tag <= 10; ++tag)
+        history.push_back(make_row(60 - ((tag + 1) / 2) * 10, tag));
+
+    return history;
+}
+
+static void require_cursor(const cursor& value, uint32_t offset,
+    const history_compact& row)
+{
+    BOOST_REQUIRE_EQUAL(value.offset, offset);
+    BOOST_REQUIRE_EQUAL(value.height, row.height);
+    BOOST_REQUIRE_EQUAL(value.kind, static_cast<uint8_t>(row.kind));
+    BOOST_REQUIRE(value.hash == row.point.hash());
+    BOOST_REQUIRE_EQUAL(value.index, row.point.index());
+}
+
+// cursor
+
+BOOST_AUTO_TEST_CASE(history_page__cursor_from_data__round_trip__expected)
+{
+    const cursor expected{ 42, 1000, 1, hash_digest{ { 0x2a } }, 7 };
+    const auto data = expected.to_data();
+    BOOST_REQUIRE_EQUAL(data.size(), 45u);
+    BOOST_REQUIRE_EQUAL(cursor::size, 45u);
+
+    cursor value;
+    BOOST_REQUIRE(value.from_data(data));
+    BOOST_REQUIRE_EQUAL(value.offset, 42u);
+    BOOST_REQUIRE_EQUAL(value.height, 1000u);
+    BOOST_REQUIRE_EQUAL(value.kind, 1u);
+    BOOST_REQUIRE(value.hash == expected.hash);
+    BOOST_REQUIRE_EQUAL(value.index, 7u);
+    BOOST_REQUIRE(!value.first());
+}
+
+BOOST_AUTO_TEST_CASE(history_page__cursor_from_data__little_endian__expected)
+{
+    data_chunk data(cursor::size, 0);
+    data[0] = 0x01;
+    data[5] = 0x02;
+    data[8] = 0x01;
+    data[9] = 0xff;
+    data[42] = 0x03;
+
+    cursor value;
+    BOOST_REQUIRE(value.from_data(data));
+    BOOST_REQUIRE_EQUAL(value.offset, 1u);
+    BOOST_REQUIRE_EQUAL(value.height, 0x0200u);
+    BOOST_REQUIRE_EQUAL(value.kind, 1u);
+    BOOST_REQUIRE_EQUAL(value.hash[0], 0xffu);
+    BOOST_REQUIRE_EQUAL(value.index, 0x0300u);
+}
+
+BOOST_AUTO_TEST_CASE(history_page__cursor_from_data__wrong_size__false)
+{
+    cursor value;
+    BOOST_REQUIRE(!value.from_data(data_chunk(cursor::size - 1, 0)));
+    BOOST_REQUIRE(!value.from_data(data_chunk(cursor::size + 1, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(history_page__cursor_first__zero__true)
+{
+    cursor value;
+    BOOST_REQUIRE(value.from_data(data_chunk(cursor::size, 0)));
+    BOOST_REQUIRE(value.first());
+    BOOST_REQUIRE(zero_cursor.to_data() == data_chunk(cursor::size, 0));
+}
+
+// select
+
+BOOST_AUTO_TEST_CASE(history_page__select__first_page__leading_rows)
+{
+    const auto history = make_history();
+    history_page page(zero_cursor, 4);
+    BOOST_REQUIRE_EQUAL(page.limit(), 4u);
+
+    // The fetch is truncated at the limit.
+    const history_compact::list fetched(history.begin(),
+        history.begin() + 4);
+    BOOST_REQUIRE(page.select(fetched, page.limit()));
+    BOOST_REQUIRE_EQUAL(page.start(), 0u);
+    BOOST_REQUIRE_EQUAL(page.end(), 4u);
+    BOOST_REQUIRE_EQUAL(page.count(), 4u);
+    require_cursor(page.next(fetched), 4, history[3]);
+}
+
+BOOST_AUTO_TEST_CASE(history_page__select__whole_history__zero_next)
+{
+    const auto history = make_history();
+    history_page page(zero_cursor, 20);
+    BOOST_REQUIRE(page.select(history, page.limit()));
+    BOOST_REQUIRE_EQUAL(page.start(), 0u);
+    BOOST_REQUIRE_EQUAL(page.count(), 10u);
+    BOOST_REQUIRE(page.next(history).first());
+}
+
+BOOST_AUTO_TEST_CASE(history_page__select__continuation__following_rows)
+{
+    const auto history = make_history();
+    history_page first(zero_cursor, 4);
+    BOOST_REQUIRE(first.select(history, 0));
+    const auto position = first.next(history);
+
+    history_page second(position, 4);
+    BOOST_REQUIRE_EQUAL(second.limit(), 12u);
+    BOOST_REQUIRE(second.select(history, second.limit()));
+    BOOST_REQUIRE_EQUAL(second.start(), 4u);
+    BOOST_REQUIRE_EQUAL(second.end(), 8u);
+    require_cursor(second.next(history), 8, history[7]);
+
+    history_page third(second.next(history), 4);
+    BOOST_REQUIRE(third.select(history, third.limit()));
+    BOOST_REQUIRE_EQUAL(third.start(), 8u);
+    BOOST_REQUIRE_EQUAL(third.count(), 2u);
+    BOOST_REQUIRE(third.next(history).first());
+}
+
+BOOST_AUTO_TEST_CASE(history_page__select__rows_inserted_above_cursor__page_unshifted)
+{
+    auto history = make_history();
+    history_page first(zero_cursor, 4);
+    BOOST_REQUIRE(first.select(history, 0));
+    const auto position = first.next(history);
+
+    // Two rows confirmed since the first page precede it.
+    history.insert(history.begin(), make_row(70, 20));
+    history.insert(history.begin(), make_row(71, 21));
+
+    history_page second(position, 4);
+    BOOST_REQUIRE(second.select(history, second.limit()));
+    BOOST_REQUIRE_EQUAL(second.start(), 6u);
+    BOOST_REQUIRE_EQUAL(second.end(), 10u);
+    BOOST_REQUIRE(history[second.start()].point.hash() ==
+        make_row(0, 5).point.hash());
+    require_cursor(second.next(history), 10, history[9]);
+}
+
+BOOST_AUTO_TEST_CASE(history_page__select__cursor_row_reorganized__first_row_below)
+{
+    auto history = make_history();
+    history_page first(zero_cursor, 3);
+    BOOST_REQUIRE(first.select(history, 0));
+    const auto position = first.next(history);
+    BOOST_REQUIRE_EQUAL(position.height, 40u);
+
+    // The cursor row and its sibling at height 40 are reorganized out.
+    history.erase(history.begin() + 2, history.begin() + 4);
+
+    history_page second(position, 3);
+    BOOST_REQUIRE(second.select(history, second.limit()));
+    BOOST_REQUIRE_EQUAL(second.start(), 2u);
+    BOOST_REQUIRE_EQUAL(history[second.start()].height, 30u);
+}
+
+BOOST_AUTO_TEST_CASE(history_page__select__cursor_beyond_limit__refetch)
+{
+    auto history = make_history();
+    history_page first(zero_cursor, 2);
+    BOOST_REQUIRE(first.select(history, 0));
+    const auto position = first.next(history);
+
+    // More rows were confirmed than the limit allows for.
+    for (uint8_t tag = 20; tag < 26; ++tag)
+        history.insert(history.begin(), make_row(100 + tag, tag));
+
+    history_page second(position, 2);
+    BOOST_REQUIRE_EQUAL(second.limit(), 6u);
+    const history_compact::list fetched(history.begin(),
+        history.begin() + second.limit());
+    BOOST_REQUIRE(!second.select(fetched, second.limit()));
+
+    // All rows are then fetched, without limit.
+    BOOST_REQUIRE(second.select(history, 0));
+    BOOST_REQUIRE_EQUAL(second.start(), 8u);
+    BOOST_REQUIRE_EQUAL(second.count(), 2u);
+    require_cursor(second.next(history), 10, history[9]);
+}
+
+BOOST_AUTO_TEST_CASE(history_page__select__cursor_beyond_history__empty)
+{
+    const auto history = make_history();
+    const cursor position{ 10, 5, 0, hash_digest{ { 0x99 } }, 0 };
+    history_page page(position, 4);
+    BOOST_REQUIRE(page.select(history, page.limit()));
+    BOOST_REQUIRE_EQUAL(page.count(), 0u);
+    BOOST_REQUIRE(page.next(history).first());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
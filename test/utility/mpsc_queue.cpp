@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <bitcoin/server.hpp>
+
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(mpsc_queue_tests)
+
+BOOST_AUTO_TEST_CASE(mpsc_queue__construct__default__empty)
+{
+    mpsc_queue<int> instance;
+    int out = 0;
+    BOOST_REQUIRE(instance.empty());
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE(!instance.pop(out));
+}
+
+BOOST_AUTO_TEST_CASE(mpsc_queue__pop__pushed__first_in_first_out)
+{
+    mpsc_queue<int> instance;
+    instance.push(1);
+    instance.push(2);
+    instance.push(3);
+    BOOST_REQUIRE_EQUAL(instance.size(), 3u);
+
+    int out = 0;
+    BOOST_REQUIRE(instance.pop(out));
+    BOOST_REQUIRE_EQUAL(out, 1);
+    BOOST_REQUIRE(instance.pop(out));
+    BOOST_REQUIRE_EQUAL(out, 2);
+    BOOST_REQUIRE(instance.pop(out));
+    BOOST_REQUIRE_EQUAL(out, 3);
+    BOOST_REQUIRE(!instance.pop(out));
+    BOOST_REQUIRE(instance.empty());
+}
+
+BOOST_AUTO_TEST_CASE(mpsc_queue__push__after_drained__popped)
+{
+    mpsc_queue<int> instance;
+    int out = 0;
+    instance.push(1);
+    BOOST_REQUIRE(instance.pop(out));
+    BOOST_REQUIRE(!instance.pop(out));
+
+    instance.push(2);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(instance.pop(out));
+    BOOST_REQUIRE_EQUAL(out, 2);
+}
+
+BOOST_AUTO_TEST_CASE(mpsc_queue__pop__move_only__moved)
+{
+    mpsc_queue<std::unique_ptr<int>> instance;
+    instance.push(std::unique_ptr<int>(new int(42)));
+
+    std::unique_ptr<int> out;
+    BOOST_REQUIRE(instance.pop(out));
+    BOOST_REQUIRE(out);
+    BOOST_REQUIRE_EQUAL(*out, 42);
+}
+
+BOOST_AUTO_TEST_CASE(mpsc_queue__destruct__not_popped__items_destroyed)
+{
+    const auto item = std::make_shared<int>(42);
+
+    {
+        mpsc_queue<std::shared_ptr<int>> instance;
+        instance.push(std::shared_ptr<int>(item));
+        instance.push(std::shared_ptr<int>(item));
+        BOOST_REQUIRE_EQUAL(item.use_count(), 3);
+    }
+
+    BOOST_REQUIRE_EQUAL(item.use_count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(mpsc_queue__pop__concurrent_producers__all_in_producer_order)
+{
+    static const size_t producers = 4;
+    static const size_t items = 10000;
+    typedef std::pair<size_t, size_t> item;
+
+    mpsc_queue<item> instance;
+    std::vector<std::thread> threads;
+
+    for (size_t producer = 0; producer < producers; ++producer)
+        threads.emplace_back([&instance, producer]()
+        {
+            for (size_t index = 0; index < items; ++index)
+                instance.push({ producer, index });
+        });
+
+    // Consume concurrently with the producers.
+    std::vector<size_t> next(producers, 0);
+    size_t popped = 0;
+    item out;
+
+    while (popped < producers * items)
+    {
+        if (!instance.pop(out))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        BOOST_REQUIRE_EQUAL(out.second, next[out.first]);
+        ++next[out.first];
+        ++popped;
+    }
+
+    for (auto& thread: threads)
+        thread.join();
+
+    BOOST_REQUIRE(instance.empty());
+    BOOST_REQUIRE(!instance.pop(out));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
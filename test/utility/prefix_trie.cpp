@@ -0,0 +1,198 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(prefix_trie_tests)
+
+typedef prefix_trie<int> trie;
+typedef std::vector<int> values;
+
+static const auto any = [](int) { return true; };
+
+static binary make_prefix(size_t bits, const data_chunk& blocks)
+{
+    return binary(bits, blocks);
+}
+
+static values matches(const trie& instance, const data_chunk& field)
+{
+    values out;
+    instance.match(field, [&out](int value) { out.push_back(value); });
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(prefix_trie__construct__default__empty)
+{
+    trie instance;
+    BOOST_REQUIRE(instance.empty());
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE(matches(instance, { 0x00 }).empty());
+}
+
+BOOST_AUTO_TEST_CASE(prefix_trie__insert__values__sized)
+{
+    trie instance;
+    instance.insert(make_prefix(4, { 0xa0 }), 1);
+    instance.insert(make_prefix(4, { 0xa0 }), 2);
+    instance.insert(make_prefix(8, { 0xa5 }), 3);
+    BOOST_REQUIRE(!instance.empty());
+    BOOST_REQUIRE_EQUAL(instance.size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(prefix_trie__find__predicate__first_satisfying)
+{
+    trie instance;
+    const auto prefix = make_prefix(4, { 0xa0 });
+    instance.insert(prefix, 1);
+    instance.insert(prefix, 2);
+    instance.insert(prefix, 4);
+
+    BOOST_REQUIRE_EQUAL(instance.find(prefix, any), 1);
+    BOOST_REQUIRE_EQUAL(instance.find(prefix,
+        [](int value) { return value % 2 == 0; }), 2);
+    BOOST_REQUIRE_EQUAL(instance.find(prefix,
+        [](int value) { return value > 4; }), 0);
+}
+
+BOOST_AUTO_TEST_CASE(prefix_trie__find__other_prefix__default)
+{
+    trie instance;
+    instance.insert(make_prefix(4, { 0xa0 }), 1);
+    BOOST_REQUIRE_EQUAL(instance.find(make_prefix(3, { 0xa0 }), any), 0);
+    BOOST_REQUIRE_EQUAL(instance.find(make_prefix(4, { 0xb0 }), any), 0);
+    BOOST_REQUIRE_EQUAL(instance.find(make_prefix(5, { 0xa0 }), any), 0);
+}
+
+BOOST_AUTO_TEST_CASE(prefix_trie__match__prefixes_of_field__increasing_length)
+{
+    trie instance;
+    instance.insert(make_prefix(8, { 0x80 }), 4);
+    instance.insert(make_prefix(2, { 0xc0 }), 3);
+    instance.insert(make_prefix(2, { 0x80 }), 2);
+    instance.insert(make_prefix(1, { 0x80 }), 1);
+    instance.insert(binary(), 0);
+
+    const auto visited = matches(instance, { 0x80, 0x00 });
+    const values expected{ 0, 1, 2, 4 };
+    BOOST_REQUIRE(visited == expected);
+}
+
+BOOST_AUTO_TEST_CASE(prefix_trie__match__full_field__visited)
+{
+    trie instance;
+    instance.insert(make_prefix(16, { 0x12, 0x34 }), 1);
+    instance.insert(make_prefix(16, { 0x12, 0x35 }), 2);
+
+    BOOST_REQUIRE(matches(instance, { 0x12, 0x34 }) == values{ 1 });
+    BOOST_REQUIRE(matches(instance, { 0x12, 0x35 }) == values{ 2 });
+    BOOST_REQUIRE(matches(instance, { 0x12 }).empty());
+}
+
+// Matching reads the field in place, so must agree with binary bit order.
+BOOST_AUTO_TEST_CASE(prefix_trie__match__all_fields__consistent_with_binary_is_prefix_of)
+{
+    const std::vector<binary> prefixes
+    {
+        binary(),
+        make_prefix(1, { 0x00 }),
+        make_prefix(1, { 0x80 }),
+        make_prefix(3, { 0x40 }),
+        make_prefix(5, { 0xa8 }),
+        make_prefix(7, { 0x12 }),
+        make_prefix(8, { 0x5a }),
+        make_prefix(9, { 0x5a, 0x80 }),
+        make_prefix(12, { 0xa5, 0xf0 })
+    };
+
+    trie instance;
+
+    for (size_t index = 0; index < prefixes.size(); ++index)
+        instance.insert(prefixes[index], static_cast<int>(index));
+
+    for (size_t high = 0; high <= std::numeric_limits<uint8_t>::max(); ++high)
+    {
+        for (const uint8_t low: { 0x00, 0x80, 0xf0, 0xff })
+        {
+            const data_chunk field{ static_cast<uint8_t>(high), low };
+            values expected;
+
+            for (size_t index = 0; index < prefixes.size(); ++index)
+                if (prefixes[index].is_prefix_of(field))
+                    expected.push_back(static_cast<int>(index));
+
+            BOOST_REQUIRE(matches(instance, field) == expected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(prefix_trie__remove__predicate__removed_and_pruned)
+{
+    trie instance;
+    const auto prefix = make_prefix(12, { 0xa5, 0xf0 });
+    instance.insert(prefix, 1);
+    instance.insert(prefix, 2);
+    instance.insert(make_prefix(4, { 0xa0 }), 3);
+
+    BOOST_REQUIRE_EQUAL(instance.remove(prefix,
+        [](int value) { return value == 1; }), 1u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE(matches(instance, { 0xa5, 0xf0 }) == (values{ 3, 2 }));
+
+    BOOST_REQUIRE_EQUAL(instance.remove(prefix, any), 1u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(matches(instance, { 0xa5, 0xf0 }) == values{ 3 });
+    BOOST_REQUIRE_EQUAL(instance.find(prefix, any), 0);
+}
+
+BOOST_AUTO_TEST_CASE(prefix_trie__remove__missing_prefix__none)
+{
+    trie instance;
+    instance.insert(make_prefix(4, { 0xa0 }), 1);
+    BOOST_REQUIRE_EQUAL(instance.remove(make_prefix(8, { 0xa5 }), any), 0u);
+    BOOST_REQUIRE_EQUAL(instance.remove(make_prefix(4, { 0xb0 }), any), 0u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(prefix_trie__remove_if__predicate__removed_from_all_prefixes)
+{
+    trie instance;
+    instance.insert(binary(), 1);
+    instance.insert(make_prefix(4, { 0xa0 }), 2);
+    instance.insert(make_prefix(8, { 0xa5 }), 3);
+    instance.insert(make_prefix(8, { 0xa5 }), 4);
+
+    const auto odd = [](int value) { return value % 2 != 0; };
+    BOOST_REQUIRE_EQUAL(instance.remove_if(odd), 2u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE(matches(instance, { 0xa5 }) == (values{ 2, 4 }));
+
+    BOOST_REQUIRE_EQUAL(instance.remove_if(any), 2u);
+    BOOST_REQUIRE(instance.empty());
+    BOOST_REQUIRE(matches(instance, { 0xa5 }).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
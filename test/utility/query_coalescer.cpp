@@ -0,0 +1,190 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <bitcoin/server.hpp>
+
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(query_coalescer_tests)
+
+typedef query_coalescer::command_handler command_handler;
+
+static const std::string command_name("blockchain.fetch_transaction2");
+
+static message make_request(uint32_t id, const bc::data_chunk& data,
+    const std::string& command=command_name)
+{
+    return message(route(), command, id, data);
+}
+
+// Records each execution, and completes only when directed.
+class recorder
+{
+public:
+    command_handler command()
+    {
+        return [this](const message& request, send_handler handler)
+        {
+            requests.push_back(request);
+            handlers.push_back(handler);
+        };
+    }
+
+    send_handler sender()
+    {
+        return [this](message&& response)
+        {
+            responses.push_back(std::move(response));
+        };
+    }
+
+    void complete(size_t index, const bc::data_chunk& data)
+    {
+        handlers[index](message(requests[index], data));
+    }
+
+    std::vector<message> requests;
+    std::vector<send_handler> handlers;
+    std::vector<message> responses;
+};
+
+BOOST_AUTO_TEST_CASE(query_coalescer__execute__single__executed_and_responded)
+{
+    query_coalescer instance;
+    recorder record;
+    const bc::data_chunk response{ 0x00, 0x00, 0x00, 0x00, 0x2a };
+    instance.execute(make_request(1, { 0x01 }), record.sender(),
+        record.command());
+
+    BOOST_REQUIRE_EQUAL(record.requests.size(), 1u);
+    BOOST_REQUIRE(record.responses.empty());
+
+    record.complete(0, response);
+    BOOST_REQUIRE_EQUAL(record.responses.size(), 1u);
+    BOOST_REQUIRE_EQUAL(record.responses[0].id(), 1u);
+    BOOST_REQUIRE(record.responses[0].data() == response);
+}
+
+BOOST_AUTO_TEST_CASE(query_coalescer__execute__identical_in_flight__executed_once)
+{
+    query_coalescer instance;
+    recorder record;
+    const bc::data_chunk response{ 0x00, 0x00, 0x00, 0x00, 0x2a };
+    instance.execute(make_request(1, { 0x01 }), record.sender(),
+        record.command());
+    instance.execute(make_request(2, { 0x01 }), record.sender(),
+        record.command());
+    instance.execute(make_request(3, { 0x01 }), record.sender(),
+        record.command());
+
+    BOOST_REQUIRE_EQUAL(record.requests.size(), 1u);
+    BOOST_REQUIRE(record.responses.empty());
+
+    // Each waiter receives the response under its own request id.
+    record.complete(0, response);
+    BOOST_REQUIRE_EQUAL(record.responses.size(), 3u);
+    BOOST_REQUIRE_EQUAL(record.responses[0].id(), 2u);
+    BOOST_REQUIRE_EQUAL(record.responses[1].id(), 3u);
+    BOOST_REQUIRE_EQUAL(record.responses[2].id(), 1u);
+
+    for (const auto& sent: record.responses)
+    {
+        BOOST_REQUIRE(sent.data() == response);
+        BOOST_REQUIRE_EQUAL(sent.command(), command_name);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(query_coalescer__execute__distinct_payloads__executed_each)
+{
+    query_coalescer instance;
+    recorder record;
+    instance.execute(make_request(1, { 0x01 }), record.sender(),
+        record.command());
+    instance.execute(make_request(2, { 0x02 }), record.sender(),
+        record.command());
+
+    BOOST_REQUIRE_EQUAL(record.requests.size(), 2u);
+
+    record.complete(1, { 0x02 });
+    BOOST_REQUIRE_EQUAL(record.responses.size(), 1u);
+    BOOST_REQUIRE_EQUAL(record.responses[0].id(), 2u);
+
+    record.complete(0, { 0x01 });
+    BOOST_REQUIRE_EQUAL(record.responses.size(), 2u);
+    BOOST_REQUIRE_EQUAL(record.responses[1].id(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(query_coalescer__execute__distinct_commands__executed_each)
+{
+    query_coalescer instance;
+    recorder record;
+    instance.execute(make_request(1, { 0x01 }), record.sender(),
+        record.command());
+    instance.execute(make_request(2, { 0x01 }, "blockchain.fetch_block_header"),
+        record.sender(), record.command());
+
+    BOOST_REQUIRE_EQUAL(record.requests.size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(query_coalescer__execute__identical_after_completion__executed_again)
+{
+    query_coalescer instance;
+    recorder record;
+    instance.execute(make_request(1, { 0x01 }), record.sender(),
+        record.command());
+    record.complete(0, { 0x01 });
+
+    instance.execute(make_request(2, { 0x01 }), record.sender(),
+        record.command());
+    BOOST_REQUIRE_EQUAL(record.requests.size(), 2u);
+
+    record.complete(1, { 0x02 });
+    BOOST_REQUIRE_EQUAL(record.responses.size(), 2u);
+    BOOST_REQUIRE_EQUAL(record.responses[1].id(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(query_coalescer__execute__synchronous_completion__responded)
+{
+    query_coalescer instance;
+    size_t executions = 0;
+    size_t responses = 0;
+
+    const command_handler command = [&executions](const message& request,
+        send_handler handler)
+    {
+        ++executions;
+        handler(message(request, bc::data_chunk{ 0x01 }));
+    };
+
+    const send_handler sender = [&responses](message&&)
+    {
+        ++responses;
+    };
+
+    instance.execute(make_request(1, { 0x01 }), sender, command);
+    instance.execute(make_request(2, { 0x01 }), sender, command);
+    BOOST_REQUIRE_EQUAL(executions, 2u);
+    BOOST_REQUIRE_EQUAL(responses, 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
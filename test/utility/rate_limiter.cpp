@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <thread>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(rate_limiter_tests)
+
+static const data_chunk alice{ 0x01 };
+static const data_chunk bob{ 0x02 };
+static const data_chunk carol{ 0x03 };
+
+BOOST_AUTO_TEST_CASE(rate_limiter__admit__zero_rate__disabled_and_admitted)
+{
+    rate_limiter instance(0, 1);
+    BOOST_REQUIRE(instance.disabled());
+
+    for (auto count = 0; count < 100; ++count)
+        BOOST_REQUIRE(instance.admit(alice));
+}
+
+BOOST_AUTO_TEST_CASE(rate_limiter__admit__new_identity__burst_admitted)
+{
+    rate_limiter instance(1, 3);
+    BOOST_REQUIRE(!instance.disabled());
+    BOOST_REQUIRE(instance.admit(alice));
+    BOOST_REQUIRE(instance.admit(alice));
+    BOOST_REQUIRE(instance.admit(alice));
+    BOOST_REQUIRE(!instance.admit(alice));
+}
+
+BOOST_AUTO_TEST_CASE(rate_limiter__admit__zero_burst__one_admitted)
+{
+    rate_limiter instance(1, 0);
+    BOOST_REQUIRE(instance.admit(alice));
+    BOOST_REQUIRE(!instance.admit(alice));
+}
+
+BOOST_AUTO_TEST_CASE(rate_limiter__admit__distinct_identities__limited_independently)
+{
+    rate_limiter instance(1, 1);
+    BOOST_REQUIRE(instance.admit(alice));
+    BOOST_REQUIRE(!instance.admit(alice));
+    BOOST_REQUIRE(instance.admit(bob));
+    BOOST_REQUIRE(!instance.admit(bob));
+    BOOST_REQUIRE(!instance.admit(alice));
+}
+
+BOOST_AUTO_TEST_CASE(rate_limiter__admit__after_refill__admitted)
+{
+    // One token refills each millisecond.
+    rate_limiter instance(1000, 1);
+    BOOST_REQUIRE(instance.admit(alice));
+    BOOST_REQUIRE(!instance.admit(alice));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    BOOST_REQUIRE(instance.admit(alice));
+}
+
+BOOST_AUTO_TEST_CASE(rate_limiter__admit__refill__limited_to_burst)
+{
+    rate_limiter instance(1000, 2);
+    BOOST_REQUIRE(instance.admit(alice));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    BOOST_REQUIRE(instance.admit(alice));
+    BOOST_REQUIRE(instance.admit(alice));
+    BOOST_REQUIRE(!instance.admit(alice));
+}
+
+BOOST_AUTO_TEST_CASE(rate_limiter__admit__clients_exhausted__new_identities_share_bucket)
+{
+    rate_limiter instance(1, 1, 1);
+    BOOST_REQUIRE(instance.admit(alice));
+
+    // Bob and carol have no bucket of their own, so share one token.
+    BOOST_REQUIRE(instance.admit(bob));
+    BOOST_REQUIRE(!instance.admit(carol));
+    BOOST_REQUIRE(!instance.admit(bob));
+
+    // Alice retains her own bucket.
+    BOOST_REQUIRE(!instance.admit(alice));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
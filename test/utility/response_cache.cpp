@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(response_cache_tests)
+
+typedef response_cache::kind kind;
+
+// The cost of an entry is its payload and a fixed overhead of 128 bytes.
+static const size_t payload_size = 10;
+static const size_t entry_cost = payload_size + 128;
+
+// Each of the 16 shards holds two entries.
+static const size_t two_per_shard = 16 * 2 * entry_cost;
+
+// The shard is selected by the first byte of the hash.
+static hash_digest make_hash(uint8_t shard, uint8_t index)
+{
+    hash_digest hash = null_hash;
+    hash[0] = shard;
+    hash[1] = index;
+    return hash;
+}
+
+static data_chunk make_payload(uint8_t fill)
+{
+    return data_chunk(payload_size, fill);
+}
+
+BOOST_AUTO_TEST_CASE(response_cache__disabled__zero_capacity__true)
+{
+    response_cache instance(0);
+    BOOST_REQUIRE(instance.disabled());
+}
+
+BOOST_AUTO_TEST_CASE(response_cache__find__disabled__false)
+{
+    response_cache instance(0);
+    const auto hash = make_hash(0, 0);
+    instance.store(kind::transaction, hash, make_payload(1),
+        instance.generation());
+
+    data_chunk out;
+    BOOST_REQUIRE(!instance.find(out, kind::transaction, hash));
+}
+
+BOOST_AUTO_TEST_CASE(response_cache__find__stored__payload)
+{
+    response_cache instance(two_per_shard);
+    BOOST_REQUIRE(!instance.disabled());
+
+    const auto hash = make_hash(0, 0);
+    const auto payload = make_payload(1);
+    instance.store(kind::transaction, hash, payload, instance.generation());
+
+    data_chunk out;
+    BOOST_REQUIRE(instance.find(out, kind::transaction, hash));
+    BOOST_REQUIRE(out == payload);
+}
+
+BOOST_AUTO_TEST_CASE(response_cache__find__other_kind__false)
+{
+    response_cache instance(two_per_shard);
+    const auto hash = make_hash(0, 0);
+    instance.store(kind::transaction, hash, make_payload(1),
+        instance.generation());
+
+    data_chunk out;
+    BOOST_REQUIRE(!instance.find(out, kind::transaction_index, hash));
+    BOOST_REQUIRE(!instance.find(out, kind::block_header, hash));
+}
+
+BOOST_AUTO_TEST_CASE(response_cache__store__existing__replaced)
+{
+    response_cache instance(two_per_shard);
+    const auto hash = make_hash(0, 0);
+    const auto payload = make_payload(2);
+    instance.store(kind::transaction, hash, make_payload(1),
+        instance.generation());
+    instance.store(kind::transaction, hash, payload, instance.generation());
+
+    data_chunk out;
+    BOOST_REQUIRE(instance.find(out, kind::transaction, hash));
+    BOOST_REQUIRE(out == payload);
+}
+
+BOOST_AUTO_TEST_CASE(response_cache__store__exceeds_shard__not_stored)
+{
+    response_cache instance(two_per_shard);
+    const auto hash = make_hash(0, 0);
+    const data_chunk payload(3 * entry_cost, 1);
+    instance.store(kind::transaction, hash, payload, instance.generation());
+
+    data_chunk out;
+    BOOST_REQUIRE(!instance.find(out, kind::transaction, hash));
+}
+
+BOOST_AUTO_TEST_CASE(response_cache__store__full_shard__least_recently_used_evicted)
+{
+    response_cache instance(two_per_shard);
+    const auto first = make_hash(3, 1);
+    const auto second = make_hash(3, 2);
+    const auto third = make_hash(3, 3);
+    const auto generation = instance.generation();
+    instance.store(kind::transaction, first, make_payload(1), generation);
+    instance.store(kind::transaction, second, make_payload(2), generation);
+
+    // Finding the first makes the second least recently used.
+    data_chunk out;
+    BOOST_REQUIRE(instance.find(out, kind::transaction, first));
+    instance.store(kind::transaction, third, make_payload(3), generation);
+
+    BOOST_REQUIRE(instance.find(out, kind::transaction, first));
+    BOOST_REQUIRE(!instance.find(out, kind::transaction, second));
+    BOOST_REQUIRE(instance.find(out, kind::transaction, third));
+}
+
+BOOST_AUTO_TEST_CASE(response_cache__store__full_other_shard__not_evicted)
+{
+    response_cache instance(two_per_shard);
+    const auto first = make_hash(3, 1);
+    const auto second = make_hash(3, 2);
+    const auto other = make_hash(4, 1);
+    const auto generation = instance.generation();
+    instance.store(kind::transaction, first, make_payload(1), generation);
+    instance.store(kind::transaction, second, make_payload(2), generation);
+    instance.store(kind::transaction, other, make_payload(3), generation);
+
+    data_chunk out;
+    BOOST_REQUIRE(instance.find(out, kind::transaction, first));
+    BOOST_REQUIRE(instance.find(out, kind::transaction, second));
+    BOOST_REQUIRE(instance.find(out, kind::transaction, other));
+}
+
+BOOST_AUTO_TEST_CASE(response_cache__invalidate__empty__generation_unchanged)
+{
+    response_cache instance(two_per_shard);
+    const auto generation = instance.generation();
+    instance.invalidate({});
+    BOOST_REQUIRE_EQUAL(instance.generation(), generation);
+}
+
+BOOST_AUTO_TEST_CASE(response_cache__invalidate__block__removes_block_responses)
+{
+    response_cache instance(two_per_shard);
+    const auto block = std::make_shared<const bc::message::block>();
+    const auto block_hash = block->header().hash();
+    const auto other = make_hash(block_hash[0], block_hash[1] + 1);
+    const auto generation = instance.generation();
+    instance.store(kind::block_header, block_hash, make_payload(1),
+        generation);
+    instance.store(kind::block_header, other, make_payload(2), generation);
+
+    instance.invalidate({ block });
+
+    data_chunk out;
+    BOOST_REQUIRE(!instance.find(out, kind::block_header, block_hash));
+    BOOST_REQUIRE(instance.find(out, kind::block_header, other));
+}
+
+BOOST_AUTO_TEST_CASE(response_cache__store__stale_generation__not_stored)
+{
+    response_cache instance(two_per_shard);
+    const auto hash = make_hash(0, 0);
+    const auto generation = instance.generation();
+
+    // A reorganization during the fetch invalidates its response.
+    instance.invalidate({ std::make_shared<const bc::message::block>() });
+    BOOST_REQUIRE_NE(instance.generation(), generation);
+    instance.store(kind::transaction, hash, make_payload(1), generation);
+
+    data_chunk out;
+    BOOST_REQUIRE(!instance.find(out, kind::transaction, hash));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
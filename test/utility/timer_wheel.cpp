@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(timer_wheel_tests)
+
+typedef timer_wheel<int> wheel;
+typedef std::vector<int> values;
+
+// Values may be due up to 2^24 ticks out.
+static const uint64_t horizon = uint64_t(1) << 24;
+
+// Times are offset by half a tick from the wheel start, which precedes the
+// captured start by much less than that, so each maps to an exact tick.
+class fixture
+{
+public:
+    fixture()
+      : instance(asio::seconds(1)), start(asio::steady_clock::now())
+    {
+    }
+
+    // A due time that rounds up to the tick.
+    wheel::time_point due_on(uint64_t tick) const
+    {
+        return start + asio::milliseconds(tick * 1000 - 500);
+    }
+
+    // A current time that rounds down to the tick.
+    wheel::time_point through(uint64_t tick) const
+    {
+        return start + asio::milliseconds(tick * 1000 + 500);
+    }
+
+    values advance(uint64_t tick)
+    {
+        values fired;
+        instance.advance(through(tick),
+            [&fired](int value) { fired.push_back(value); });
+        return fired;
+    }
+
+    wheel instance;
+    const wheel::time_point start;
+};
+
+BOOST_AUTO_TEST_CASE(timer_wheel__advance__empty__none)
+{
+    fixture test;
+    BOOST_REQUIRE_EQUAL(test.instance.size(), 0u);
+    BOOST_REQUIRE(test.advance(100).empty());
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__advance__due__fired_on_tick_only)
+{
+    fixture test;
+    test.instance.schedule(test.due_on(3), 1);
+    BOOST_REQUIRE_EQUAL(test.instance.size(), 1u);
+
+    BOOST_REQUIRE(test.advance(2).empty());
+    BOOST_REQUIRE_EQUAL(test.instance.size(), 1u);
+
+    BOOST_REQUIRE(test.advance(3) == values{ 1 });
+    BOOST_REQUIRE_EQUAL(test.instance.size(), 0u);
+    BOOST_REQUIRE(test.advance(10).empty());
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__advance__same_tick__all_fired)
+{
+    fixture test;
+    test.instance.schedule(test.due_on(5), 1);
+    test.instance.schedule(test.due_on(5), 2);
+    test.instance.schedule(test.due_on(6), 3);
+
+    BOOST_REQUIRE(test.advance(5) == (values{ 1, 2 }));
+    BOOST_REQUIRE(test.advance(6) == values{ 3 });
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__advance__past_due__fired_on_next_tick)
+{
+    fixture test;
+    BOOST_REQUIRE(test.advance(5).empty());
+
+    // Ticks through the current have been processed.
+    test.instance.schedule(test.start, 1);
+    test.instance.schedule(test.due_on(5), 2);
+    BOOST_REQUIRE(test.advance(5).empty());
+    BOOST_REQUIRE(test.advance(6) == (values{ 1, 2 }));
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__advance__higher_levels__cascaded_to_tick)
+{
+    fixture test;
+
+    // Levels span 64, 4096 and 262144 ticks.
+    test.instance.schedule(test.due_on(64 * 2 + 5), 1);
+    test.instance.schedule(test.due_on(4096 + 64 * 3 + 7), 2);
+    test.instance.schedule(test.due_on(262144 * 2 + 4096 + 1), 3);
+
+    BOOST_REQUIRE(test.advance(64 * 2 + 4).empty());
+    BOOST_REQUIRE(test.advance(64 * 2 + 5) == values{ 1 });
+    BOOST_REQUIRE(test.advance(4096 + 64 * 3 + 6).empty());
+    BOOST_REQUIRE(test.advance(4096 + 64 * 3 + 7) == values{ 2 });
+    BOOST_REQUIRE(test.advance(262144 * 2 + 4096).empty());
+    BOOST_REQUIRE(test.advance(262144 * 2 + 4096 + 1) == values{ 3 });
+    BOOST_REQUIRE_EQUAL(test.instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__advance__unaligned_schedule__cascaded_to_tick)
+{
+    fixture test;
+    BOOST_REQUIRE(test.advance(100).empty());
+
+    // Scheduled from a tick within a higher level slot.
+    test.instance.schedule(test.due_on(100 + 64), 1);
+    test.instance.schedule(test.due_on(100 + 4096 + 63), 2);
+
+    BOOST_REQUIRE(test.advance(100 + 63).empty());
+    BOOST_REQUIRE(test.advance(100 + 64) == values{ 1 });
+    BOOST_REQUIRE(test.advance(100 + 4096 + 62).empty());
+    BOOST_REQUIRE(test.advance(100 + 4096 + 63) == values{ 2 });
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__advance__rescheduled_by_handler__fired_again)
+{
+    fixture test;
+    values fired;
+    test.instance.schedule(test.due_on(2), 1);
+
+    // Each value reschedules its successor two ticks later, up to three.
+    const auto handler = [&](int value)
+    {
+        fired.push_back(value);
+
+        if (value < 3)
+            test.instance.schedule(test.due_on(2 * (value + 1)), value + 1);
+    };
+
+    test.instance.advance(test.through(5), handler);
+    BOOST_REQUIRE(fired == (values{ 1, 2 }));
+    BOOST_REQUIRE_EQUAL(test.instance.size(), 1u);
+
+    test.instance.advance(test.through(6), handler);
+    BOOST_REQUIRE(fired == (values{ 1, 2, 3 }));
+    BOOST_REQUIRE_EQUAL(test.instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__advance__rescheduled_past_due__fired_on_next_tick)
+{
+    fixture test;
+    values fired;
+    test.instance.schedule(test.due_on(1), 1);
+
+    const auto handler = [&](int value)
+    {
+        fired.push_back(value);
+
+        if (value == 1)
+            test.instance.schedule(test.start, 2);
+    };
+
+    test.instance.advance(test.through(1), handler);
+    BOOST_REQUIRE(fired == values{ 1 });
+
+    test.instance.advance(test.through(2), handler);
+    BOOST_REQUIRE(fired == (values{ 1, 2 }));
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__advance__beyond_horizon__fired_at_horizon)
+{
+    fixture test;
+    test.instance.schedule(test.due_on(horizon + 100), 1);
+    BOOST_REQUIRE(test.advance(horizon - 2).empty());
+    BOOST_REQUIRE(test.advance(horizon - 1) == values{ 1 });
+}
+
+BOOST_AUTO_TEST_SUITE_END()